@@ -0,0 +1,379 @@
+/**
+ * scrabble_alphagram.cpp
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Implements the alphagram index declared in scrabble_alphagram.h.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "scrabble_alphagram.h"
+
+/**
+ * @param   letters     a word or a rack of letters
+ * @return              the letters in alphabetical order
+ */
+string make_alphagram (string letters)
+{
+    sort(letters.begin(), letters.end());
+    return letters;
+}
+
+/**
+ * Hashes an alphagram with the 64 bit FNV-1a hash. The lower bits choose the
+ * first slot to probe and the upper bits are kept in the slot so that most
+ * slots of other alphagrams are skipped without comparing words.
+ *
+ * @param   alphagram   the alphagram to hash
+ * @return              the hash
+ */
+uint64_t hash_alphagram (const string &alphagram)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (unsigned int i = 0; i < alphagram.length(); i++)
+    {
+        hash ^= (unsigned char) alphagram[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * @param   index   an alphagram index
+ * @param   offset  the offset of a word in the index's word_text
+ * @return          the word at the offset
+ */
+static string get_word (const AlphagramIndex &index, uint32_t offset)
+{
+    const char* start = index.word_text + offset;
+    const char* end = (const char*) memchr(start, '\n',
+                                           index.word_text_size - offset);
+    return string(start, end - start);
+}
+
+/**
+ * @param   index   an alphagram index
+ * @param   offset  the offset of a word in the index's word_text
+ * @param   word    a word
+ * @return          true if the word at the offset is the word
+ */
+static bool is_word_at (const AlphagramIndex &index, uint32_t offset,
+                        const string &word)
+{
+    return offset + word.length() < index.word_text_size &&
+           memcmp(index.word_text + offset, word.data(), word.length()) == 0 &&
+           index.word_text[offset + word.length()] == '\n';
+}
+
+/**
+ * Builds the alphagram section of a lexicon image for every word of a list.
+ *
+ * @param   word_text   every word, each ending in '\n', which is the words
+ *                      section of the same image
+ * @return              the bytes of the section, which
+ *                      read_alphagram_section reads as an AlphagramIndex
+ */
+string build_alphagram_section (const string &word_text)
+{
+    vector <uint32_t> groups;
+    vector <uint32_t> word_offsets;
+
+    // Sort the words by alphagram. The sort is stable, so the words of each
+    // alphagram stay in the order of word_text.
+    vector <pair <string, uint32_t> > entries;
+    uint32_t word_start = 0;
+
+    for (uint32_t i = 0; i < word_text.length(); i++)
+    {
+        if (word_text[i] == '\n')
+        {
+            if (i > word_start)
+            {
+                entries.push_back(make_pair(make_alphagram(
+                    word_text.substr(word_start, i - word_start)), word_start));
+            }
+
+            word_start = i + 1;
+        }
+    }
+
+    stable_sort(entries.begin(), entries.end(),
+                [](const pair <string, uint32_t> &a,
+                   const pair <string, uint32_t> &b)
+                {
+                    return a.first < b.first;
+                });
+
+    for (unsigned int i = 0; i < entries.size(); i++)
+    {
+        if (i == 0 || entries[i].first != entries[i-1].first)
+        {
+            groups.push_back(i);
+        }
+
+        word_offsets.push_back(entries[i].second);
+    }
+
+    groups.push_back(entries.size());
+
+    // Keep the table at most three quarters full to keep probes short, and
+    // always leave an empty slot so that a probe for a missing alphagram ends
+    uint32_t num_groups = groups.size() - 1;
+    uint32_t num_slots = 1;
+
+    while ((uint64_t) num_slots * 3 < (uint64_t) num_groups * 4 ||
+           num_slots <= num_groups)
+    {
+        num_slots *= 2;
+    }
+
+    AlphagramSlot empty_slot = {0, EMPTY_ALPHAGRAM_SLOT};
+    vector <AlphagramSlot> slots (num_slots, empty_slot);
+
+    for (uint32_t group = 0; group < num_groups; group++)
+    {
+        uint64_t hash = hash_alphagram(entries[groups[group]].first);
+        uint32_t slot = hash & (num_slots - 1);
+
+        while (slots[slot].group != EMPTY_ALPHAGRAM_SLOT)
+        {
+            slot = (slot + 1) & (num_slots - 1);
+        }
+
+        slots[slot].hash = hash >> 32;
+        slots[slot].group = group;
+    }
+
+    AlphagramIndex index;
+    index.slots = slots.data();
+    index.num_slots = num_slots;
+    index.groups = groups.data();
+    index.num_groups = num_groups;
+    index.word_offsets = word_offsets.data();
+    index.num_words = word_offsets.size();
+
+    return write_alphagram_section(index);
+}
+
+/**
+ * Converts an alphagram index into the alphagram section of a lexicon image.
+ * The word text is not included since it is the words section of the image.
+ *
+ * @param   index   the index to convert
+ * @return          the bytes of the section
+ */
+string write_alphagram_section (const AlphagramIndex &index)
+{
+    AlphagramSectionHeader header;
+    header.num_slots = index.num_slots;
+    header.num_groups = index.num_groups;
+    header.num_words = index.num_words;
+    header.reserved = 0;
+
+    string section ((const char*) &header, sizeof(header));
+    section.append((const char*) index.slots,
+                   index.num_slots * sizeof(AlphagramSlot));
+    section.append((const char*) index.groups,
+                   (index.num_groups + 1) * sizeof(uint32_t));
+    section.append((const char*) index.word_offsets,
+                   index.num_words * sizeof(uint32_t));
+
+    return section;
+}
+
+/**
+ * Reads an alphagram index from the alphagram section of a lexicon image. The
+ * index points into the sections, which must start at a multiple of 4 bytes
+ * and be kept for as long as the index is used.
+ *
+ * @param   section         the bytes of the section
+ * @param   size            the number of bytes in the section
+ * @param   word_text       the words section of the same image
+ * @param   word_text_size  the number of bytes in the words section
+ * @param   index           the index to fill in
+ * @return                  true if the section was valid
+ */
+bool read_alphagram_section (const char* section, uint64_t size,
+                             const char* word_text, uint64_t word_text_size,
+                             AlphagramIndex &index)
+{
+    AlphagramSectionHeader header;
+
+    if (section == NULL || size < sizeof(header) || word_text == NULL ||
+        (word_text_size > 0 && word_text[word_text_size - 1] != '\n'))
+    {
+        return false;
+    }
+
+    memcpy(&header, section, sizeof(header));
+
+    // Ensure the section is exactly the size given by its header
+    uint64_t expected_size = sizeof(header)
+                           + (uint64_t) header.num_slots * sizeof(AlphagramSlot)
+                           + ((uint64_t) header.num_groups + 1) * 4
+                           + (uint64_t) header.num_words * 4;
+
+    if (size != expected_size || header.num_slots == 0 ||
+        (header.num_slots & (header.num_slots - 1)) != 0 ||
+        header.num_groups >= header.num_slots)
+    {
+        return false;
+    }
+
+    const char* data = section + sizeof(header);
+    index.slots = (const AlphagramSlot*) data;
+    index.num_slots = header.num_slots;
+    data += header.num_slots * sizeof(AlphagramSlot);
+
+    index.groups = (const uint32_t*) data;
+    index.num_groups = header.num_groups;
+    data += (header.num_groups + 1) * 4;
+
+    index.word_offsets = (const uint32_t*) data;
+    index.num_words = header.num_words;
+
+    index.word_text = word_text;
+    index.word_text_size = word_text_size;
+
+    // Ensure every group, slot and word offset points inside the index
+    for (uint32_t i = 0; i < header.num_groups; i++)
+    {
+        if (index.groups[i] >= index.groups[i + 1])
+        {
+            return false;
+        }
+    }
+
+    if (index.groups[header.num_groups] != header.num_words)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.num_slots; i++)
+    {
+        if (index.slots[i].group != EMPTY_ALPHAGRAM_SLOT &&
+            index.slots[i].group >= header.num_groups)
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header.num_words; i++)
+    {
+        if (index.word_offsets[i] >= word_text_size)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Finds the words with an alphagram.
+ *
+ * @param   index       the index to search
+ * @param   alphagram   the alphagram, made by make_alphagram
+ * @param   words       the words found are added to the end
+ * @return              the number of words found
+ */
+size_t find_alphagram_words (const AlphagramIndex &index,
+                             const string &alphagram, vector <string> &words)
+{
+    if (index.num_slots == 0)
+    {
+        return 0;
+    }
+
+    uint64_t hash = hash_alphagram(alphagram);
+    uint32_t mask = index.num_slots - 1;
+    uint32_t slot = hash & mask;
+
+    // Probe until an empty slot, checking the words of each matching hash
+    while (index.slots[slot].group != EMPTY_ALPHAGRAM_SLOT)
+    {
+        if (index.slots[slot].hash == (uint32_t) (hash >> 32))
+        {
+            uint32_t group = index.slots[slot].group;
+            uint32_t first = index.groups[group];
+            uint32_t last = index.groups[group + 1];
+
+            if (make_alphagram(get_word(index, index.word_offsets[first]))
+                == alphagram)
+            {
+                for (uint32_t i = first; i < last; i++)
+                {
+                    words.push_back(get_word(index, index.word_offsets[i]));
+                }
+
+                return last - first;
+            }
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return 0;
+}
+
+/**
+ * Finds the position of a word in an alphagram index. The words are numbered
+ * in the order of word_offsets, so the position can be used to keep other
+ * data about each word in an array.
+ *
+ * @param   index   the index to search
+ * @param   word    the word to find
+ * @return          the position of the word in word_offsets, or
+ *                  NO_ALPHAGRAM_WORD if it is not in the index
+ */
+uint32_t find_alphagram_word (const AlphagramIndex &index, const string &word)
+{
+    if (index.num_slots == 0)
+    {
+        return NO_ALPHAGRAM_WORD;
+    }
+
+    uint64_t hash = hash_alphagram(make_alphagram(word));
+    uint32_t mask = index.num_slots - 1;
+    uint32_t slot = hash & mask;
+
+    // Probe until an empty slot. The word is in the group of its alphagram,
+    // so the words of other groups never match.
+    while (index.slots[slot].group != EMPTY_ALPHAGRAM_SLOT)
+    {
+        if (index.slots[slot].hash == (uint32_t) (hash >> 32))
+        {
+            uint32_t group = index.slots[slot].group;
+
+            for (uint32_t i = index.groups[group];
+                 i < index.groups[group + 1]; i++)
+            {
+                if (is_word_at(index, index.word_offsets[i], word))
+                {
+                    return i;
+                }
+            }
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    return NO_ALPHAGRAM_WORD;
+}
+
+/**
+ * @param   index   an alphagram index
+ * @return          the number of bytes used by the index
+ */
+long long measure_alphagram_index (const AlphagramIndex &index)
+{
+    return (long long) index.num_slots * sizeof(AlphagramSlot)
+         + ((long long) index.num_groups + 1) * sizeof(uint32_t)
+         + (long long) index.num_words * sizeof(uint32_t)
+         + index.word_text_size;
+}
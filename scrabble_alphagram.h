@@ -0,0 +1,78 @@
+/**
+ * scrabble_alphagram.h
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: An index from alphagrams to words. The alphagram of a word is its
+ *          letters in alphabetical order (ex. AEINRST for RETAINS), so the
+ *          anagrams of a rack are the words with the rack's alphagram. The
+ *          index is a hash table with open addressing that is built with the
+ *          lexicon and stored in the lexicon image.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#ifndef SCRABBLE_ALPHAGRAM_H
+#define SCRABBLE_ALPHAGRAM_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#define EMPTY_ALPHAGRAM_SLOT 0xFFFFFFFF
+#define NO_ALPHAGRAM_WORD 0xFFFFFFFF
+
+using namespace std;
+
+struct AlphagramSlot
+{
+    uint32_t hash;      // The upper half of the alphagram's 64 bit hash
+    uint32_t group;     // The alphagram's group or EMPTY_ALPHAGRAM_SLOT
+};
+
+// The start of the alphagram section of a lexicon image, which is followed by
+// the slots, the groups and the word offsets of the index
+struct AlphagramSectionHeader
+{
+    uint32_t num_slots;
+    uint32_t num_groups;
+    uint32_t num_words;
+    uint32_t reserved;
+};
+
+// The arrays are those of an alphagram section and the words section of a
+// lexicon image (see read_alphagram_section), so they are not copied from
+// the image.
+struct AlphagramIndex
+{
+    const AlphagramSlot* slots = NULL;
+    uint32_t num_slots = 0;         // A power of 2
+
+    // The words of group i are word_offsets[groups[i]] up to (not including)
+    // word_offsets[groups[i + 1]]
+    const uint32_t* groups = NULL;
+    uint32_t num_groups = 0;        // groups has num_groups + 1 entries
+
+    // The offset of each word in word_text, sorted by alphagram and then by
+    // word
+    const uint32_t* word_offsets = NULL;
+    uint32_t num_words = 0;
+
+    const char* word_text = NULL;   // Every word, each ending in '\n'
+    uint64_t word_text_size = 0;
+};
+
+// Declare functions
+string make_alphagram (string letters);
+uint64_t hash_alphagram (const string &alphagram);
+string build_alphagram_section (const string &word_text);
+string write_alphagram_section (const AlphagramIndex &index);
+bool read_alphagram_section (const char* section, uint64_t size,
+                             const char* word_text, uint64_t word_text_size,
+                             AlphagramIndex &index);
+size_t find_alphagram_words (const AlphagramIndex &index,
+                             const string &alphagram, vector <string> &words);
+uint32_t find_alphagram_word (const AlphagramIndex &index, const string &word);
+long long measure_alphagram_index (const AlphagramIndex &index);
+
+#endif
@@ -0,0 +1,1445 @@
+/**
+ * scrabble_bench.cpp
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Generates a corpus of positions by having an engine play against
+ *          itself and times the engine on every position of a corpus,
+ *          optionally with the hardware performance counters. The self-test
+ *          checks on the same corpus that the different ways of storing the
+ *          lexicon and the board give the same results.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <sys/resource.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+#include "scrabble_bench.h"
+#include "scrabble_lexicon.h"
+#include "scrabble_trace.h"
+
+/**
+ * @param   engine  the engine whose tiles are used
+ * @return          a string containing every tile of a full Scrabble bag,
+ *                  with '*' for the blank tiles
+ */
+string fill_bag (const Engine &engine)
+{
+    const vector <Tile> &tiles = engine.get_tiles();
+    string bag;
+
+    for (unsigned int i = 0; i < tiles.size(); i++)
+    {
+        bag += string(tiles[i].total, tiles[i].letter);
+    }
+
+    return bag;
+}
+
+/**
+ * Randomly removes tiles from a bag. Tiles whose letters are in "wanted" are
+ * drawn first if there are any left.
+ *
+ * @param   bag         the tiles that can be drawn. It is passed by reference
+ *                      since the drawn tiles are removed from it.
+ * @param   num_tiles   the number of tiles to draw
+ * @param   wanted      the letters to draw first or "" for any letter
+ * @param   rng         the seeded random number generator
+ * @return              the drawn tiles (fewer than num_tiles if the bag
+ *                      does not have enough tiles)
+ */
+string draw_tiles (string &bag, int num_tiles, string wanted, mt19937 &rng)
+{
+    string tiles;
+
+    while ((int) tiles.length() < num_tiles && bag.length() > 0)
+    {
+        // Find the positions in the bag of the tiles that can be drawn
+        vector <int> candidates;
+
+        for (unsigned int i = 0; i < bag.length(); i++)
+        {
+            if (wanted == "" || wanted.find(bag[i]) != string::npos)
+            {
+                candidates.push_back(i);
+            }
+        }
+
+        // Stop if the bag is out of the wanted tiles
+        if (candidates.size() == 0)
+        {
+            break;
+        }
+
+        // Use the modulo of the raw output rather than a distribution
+        // so that the same seed gives the same corpus on every platform
+        int index = candidates[rng() % candidates.size()];
+        tiles += bag[index];
+        bag.erase(index, 1);
+    }
+
+    return tiles;
+}
+
+/**
+ * Draws a rack of a given type from the tiles that are not on the board.
+ *      balanced = 3 vowels and 4 consonants with no blanks
+ *      blank    = 2 blanks and 5 other tiles
+ *      vowel    = 5 vowels and 2 consonants with no blanks
+ *
+ * @param   pool        the tiles that are not on the board
+ * @param   rack_type   "balanced", "blank" or "vowel"
+ * @param   rng         the seeded random number generator
+ * @return              the tiles in the rack
+ */
+string draw_rack_of_type (string pool, string rack_type, mt19937 &rng)
+{
+    string vowels = "AEIOU";
+    string consonants = "BCDFGHJKLMNPQRSTVWXYZ";
+    string rack;
+
+    if (rack_type == "blank")
+    {
+        rack = draw_tiles(pool, 2, "*", rng);
+        rack += draw_tiles(pool, NUM_RACK_TILES - rack.length(),
+                           vowels + consonants, rng);
+    }
+    else
+    {
+        int num_vowels = (rack_type == "vowel") ? 5 : 3;
+        rack = draw_tiles(pool, num_vowels, vowels, rng);
+        rack += draw_tiles(pool, NUM_RACK_TILES - rack.length(),
+                           consonants, rng);
+    }
+
+    // Top up the rack if the pool ran out of the requested kind of tile
+    rack += draw_tiles(pool, NUM_RACK_TILES - rack.length(),
+                       vowels + consonants, rng);
+
+    return rack;
+}
+
+/**
+ * Generates positions by having the program play against itself until the
+ * board reaches each target number of tiles. At each target, one position
+ * is recorded for every type of rack. The blanks are kept out of the games
+ * so that every position can be given a blank-heavy rack.
+ *
+ * @param   engine      the engine that plays the games
+ * @param   seed        the seed of the random number generator
+ * @param   num_games   the number of games to play
+ * @return              the generated positions
+ */
+vector <CorpusPosition> generate_corpus (const Engine &engine,
+                                         unsigned int seed, int num_games)
+{
+    vector <CorpusPosition> corpus;
+    int targets[] = {10, 40, 70, 90};
+    int num_targets = 4;
+    string rack_types[] = {"balanced", "blank", "vowel"};
+    mt19937 rng (seed);
+
+    for (int game = 0; game < num_games; game++)
+    {
+        SquareGrid board = engine.new_board();
+        string bag = fill_bag(engine);
+        string blanks = draw_tiles(bag, 2, "*", rng);
+        string rack_str = draw_tiles(bag, NUM_RACK_TILES, "", rng);
+        int next_target = 0;
+        int num_passes = 0;
+
+        // Play until every target is reached or neither player can move
+        while (next_target < num_targets && num_passes < 2)
+        {
+            TraceSpan span ("self_play_move", "simulation");
+
+            engine.update_board(board);
+
+            Move best_move = {};
+            engine.find_best_move(board, fill_rack(rack_str), best_move);
+
+            // Exchange the whole rack if there is no move
+            if (best_move.num_tiles == 0)
+            {
+                num_passes++;
+
+                if (bag.length() >= NUM_RACK_TILES)
+                {
+                    string old_rack = rack_str;
+                    rack_str = draw_tiles(bag, NUM_RACK_TILES, "", rng);
+                    bag += old_rack;
+                }
+
+                continue;
+            }
+
+            num_passes = 0;
+            engine.add_move_to_board(board, best_move);
+
+            // Remove the played tiles from the rack and refill it
+            for (int i = 0; i < best_move.length; i++)
+            {
+                if (best_move.tiles[i] == '.')
+                {
+                    continue;
+                }
+
+                char tile = isupper(best_move.tiles[i]) ?
+                            best_move.tiles[i] : '*';
+                rack_str.erase(rack_str.find(tile), 1);
+            }
+
+            rack_str += draw_tiles(bag, NUM_RACK_TILES - rack_str.length(),
+                                   "", rng);
+
+            // Record the positions for every target that was just reached
+            int num_tiles = count_board_tiles(board);
+
+            while (next_target < num_targets &&
+                   num_tiles >= targets[next_target])
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    CorpusPosition position;
+                    position.target_tiles = targets[next_target];
+                    position.num_tiles = num_tiles;
+                    position.rack_type = rack_types[i];
+                    position.rack = draw_rack_of_type(bag + rack_str + blanks,
+                                                      rack_types[i], rng);
+                    position.letters = board_to_string(board);
+                    corpus.push_back(position);
+                }
+
+                next_target++;
+            }
+        }
+    }
+
+    return corpus;
+}
+
+/**
+ * Writes the positions to a corpus file. Each line after the header stores
+ * the target tiles, actual tiles, rack type, rack, and board letters.
+ *
+ * @param   corpus      the positions to write
+ * @param   seed        the seed used to generate the corpus
+ * @param   file_name   the name of the corpus file
+ * @return              false if the file could not be written
+ */
+bool write_corpus (vector <CorpusPosition> &corpus, unsigned int seed,
+                   string file_name)
+{
+    ofstream out_file;
+    out_file.open(file_name.c_str(), ofstream::out);
+
+    // Ensure file is open
+    if (!out_file.is_open())
+    {
+        cerr << "Could not open " << file_name << endl;
+        return false;
+    }
+
+    out_file << "# scrabbl-ai corpus v1 seed " << seed << endl;
+
+    for (unsigned int i = 0; i < corpus.size(); i++)
+    {
+        out_file << corpus[i].target_tiles << " "
+                 << corpus[i].num_tiles    << " "
+                 << corpus[i].rack_type    << " "
+                 << corpus[i].rack         << " "
+                 << corpus[i].letters      << endl;
+    }
+
+    return out_file.good();
+}
+
+/**
+ * @param   file_name   the name of a corpus file created by write_corpus
+ * @return              the positions stored in the corpus file
+ */
+vector <CorpusPosition> read_corpus (string file_name)
+{
+    vector <CorpusPosition> corpus;
+
+    // Open file containing the corpus
+    ifstream in_file;
+    in_file.open(file_name.c_str(), ifstream::in);
+
+    // Ensure file is open
+    if (!in_file.is_open())
+    {
+        cerr << "Could not open " << file_name << endl;
+        return corpus;
+    }
+
+    string line;
+
+    while (getline(in_file, line))
+    {
+        // Skip the header and any blank lines
+        if (line.length() == 0 || line[0] == '#')
+        {
+            continue;
+        }
+
+        CorpusPosition position;
+        istringstream line_stream (line);
+        line_stream >> position.target_tiles >> position.num_tiles
+                    >> position.rack_type >> position.rack >> position.letters;
+
+        if (position.letters.length() ==
+            (unsigned int) (NUM_BOARD_ROWS * NUM_BOARD_COLS))
+        {
+            corpus.push_back(position);
+        }
+    }
+
+    return corpus;
+}
+
+/**
+ * Finds the best move for positions of the corpus until every position has
+ * been taken. Several threads can call this function at the same time, each
+ * taking the next position that has not been taken yet.
+ *
+ * After each search, the best move is played and the same rack is searched
+ * again, as in a simulation, to time a search of a board that has only
+ * changed a little.
+ *
+ * @param   engine          the engine to time, shared by every thread
+ * @param   corpus          the positions to time
+ * @param   next_position   the index of the next position to take
+ * @param   results         the result of each position, filled in by index
+ * @param   use_perf        true to read the hardware performance counters
+ * @param   cache           the thread's own MoveCache or NULL to not use one
+ * @param   moves           the thread's own MoveList or NULL to not use one.
+ *                          With a MoveList, the second search only searches
+ *                          the rows and columns that changed.
+ * @param   pool            the thread's own SearchPool
+ */
+void benchmark_positions (const Engine &engine,
+                          const vector <CorpusPosition> &corpus,
+                          atomic <unsigned int> &next_position,
+                          vector <BenchResult> &results, bool use_perf,
+                          MoveCache* cache, MoveList* moves, SearchPool* pool)
+{
+    // Each thread has its own search state and its own counters. The board
+    // and rack of each position are copied into the same memory.
+    SearchContext context = {};
+    context.move_cache = cache;
+    context.pool = pool;
+    PerfCounters counters = {{0}, {0}};
+    use_perf = use_perf && open_perf_counters(counters);
+    SquareGrid empty_board = engine.new_board();
+    SquareGrid board = empty_board;
+    vector <int> rack;
+
+    for (unsigned int i = next_position++; i < corpus.size();
+         i = next_position++)
+    {
+        TraceSpan span ("position", "bench");
+        board = empty_board;
+        string_to_board(corpus[i].letters, board);
+        fill_rack(corpus[i].rack, rack);
+        context.trie_edges_visited = 0;
+
+        if (use_perf)
+        {
+            start_perf_counters(counters);
+        }
+
+        auto start = chrono::steady_clock::now();
+
+        Move best_move = {};
+
+        if (moves != NULL)
+        {
+            moves->is_valid = false;
+            engine.update_move_list(board, rack, *moves, context);
+            best_move = moves->best_move;
+        }
+        else
+        {
+            engine.update_board(board);
+            engine.find_best_move(board, rack, best_move, context);
+        }
+
+        auto end = chrono::steady_clock::now();
+
+        if (use_perf)
+        {
+            stop_perf_counters(counters);
+        }
+
+        results[i].best_pts = best_move.score;
+        results[i].trie_edges = context.trie_edges_visited;
+        results[i].micros =
+                    chrono::duration <double, micro> (end - start).count();
+
+        for (int j = 0; j < NUM_PERF_COUNTERS; j++)
+        {
+            results[i].counters[j] = use_perf ? counters.values[j] : 0;
+        }
+
+        // Play the best move and search again with the same rack
+        engine.add_move_to_board(board, best_move);
+        start = chrono::steady_clock::now();
+
+        if (moves != NULL)
+        {
+            engine.update_move_list(board, rack, *moves, context);
+        }
+        else
+        {
+            engine.update_board(board);
+            engine.find_best_move(board, rack, best_move, context);
+        }
+
+        end = chrono::steady_clock::now();
+        results[i].requery_micros =
+                    chrono::duration <double, micro> (end - start).count();
+    }
+
+    if (use_perf)
+    {
+        close_perf_counters(counters);
+    }
+}
+
+/**
+ * Times find_best_move on every position of a corpus file. Outputs the best
+ * points and the trie edges visited for each position, so that two runs can be
+ * compared for regressions, followed by the average time for each density
+ * bucket, the throughput, and the memory report. The hardware counters of
+ * every density and rack type are also output if they are used.
+ *
+ * @param   engine          the engine to time
+ * @param   file_name       the name of a corpus file created by write_corpus
+ * @param   budget_bytes    the memory budget or 0 if there is no budget
+ * @param   use_perf        true to read the hardware performance counters
+ * @param   num_threads     the number of threads sharing the engine
+ * @param   use_cache       true to give each thread a MoveCache
+ * @param   use_move_list   true to give each thread a MoveList
+ */
+void run_benchmark (const Engine &engine, string file_name,
+                    long long budget_bytes, bool use_perf, int num_threads,
+                    bool use_cache, bool use_move_list)
+{
+    vector <CorpusPosition> corpus = read_corpus(file_name);
+    vector <BenchResult> results (corpus.size());
+
+    // The total time and number of positions for each density bucket
+    map <int, double> bucket_micros;
+    map <int, double> bucket_requery_micros;
+    map <int, int> bucket_positions;
+
+    // The totals for each density bucket and rack type
+    map <pair <int, string>, BenchCase> cases;
+
+    // Check that the counters can be opened. Each thread opens its own.
+    PerfCounters counters = {{0}, {0}};
+
+    if (use_perf && !open_perf_counters(counters))
+    {
+        cerr << "Could not open the perf counters: " << strerror(errno) << endl;
+        use_perf = false;
+    }
+
+    // Time the positions on num_threads threads that share the engine
+    atomic <unsigned int> next_position (0);
+    vector <thread> threads;
+    MoveCache empty_cache;
+    empty_cache.max_rows = MAX_CACHED_ROWS;
+    empty_cache.hits = 0;
+    empty_cache.misses = 0;
+    vector <MoveCache> caches (max(num_threads, 1), empty_cache);
+    vector <MoveList> move_lists (max(num_threads, 1));
+    vector <SearchPool> pools (max(num_threads, 1));
+    auto start = chrono::steady_clock::now();
+
+    for (int i = 0; i < max(num_threads, 1); i++)
+    {
+        threads.push_back(thread(benchmark_positions, cref(engine),
+                                 cref(corpus), ref(next_position),
+                                 ref(results), use_perf,
+                                 use_cache ? &caches[i] : (MoveCache*) NULL,
+                                 use_move_list ? &move_lists[i] :
+                                                 (MoveList*) NULL,
+                                 &pools[i]));
+    }
+
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+        threads[i].join();
+    }
+
+    auto end = chrono::steady_clock::now();
+    double wall_micros = chrono::duration <double, micro> (end - start).count();
+
+    cout << "target tiles rack_type rack points trie_edges micros" << endl;
+
+    for (unsigned int i = 0; i < corpus.size(); i++)
+    {
+        bucket_micros[corpus[i].target_tiles] += results[i].micros;
+        bucket_requery_micros[corpus[i].target_tiles] +=
+                                                    results[i].requery_micros;
+        bucket_positions[corpus[i].target_tiles]++;
+
+        // Add the position to the totals of its case
+        pair <int, string> key (corpus[i].target_tiles, corpus[i].rack_type);
+
+        if (cases.find(key) == cases.end())
+        {
+            BenchCase bench_case = {0, 0, {0}};
+            cases[key] = bench_case;
+        }
+
+        cases[key].positions++;
+        cases[key].trie_edges += results[i].trie_edges;
+
+        for (int j = 0; j < NUM_PERF_COUNTERS; j++)
+        {
+            cases[key].counters[j] += results[i].counters[j];
+        }
+
+        cout << corpus[i].target_tiles  << " "
+             << corpus[i].num_tiles     << " "
+             << corpus[i].rack_type     << " "
+             << corpus[i].rack          << " "
+             << results[i].best_pts     << " "
+             << results[i].trie_edges   << " "
+             << (long) results[i].micros << endl;
+    }
+
+    // Output the average time for each density bucket
+    cout << endl;
+    cout << "target positions avg_micros avg_requery_micros" << endl;
+
+    for (auto itr = bucket_micros.begin(); itr != bucket_micros.end(); itr++)
+    {
+        int num_positions = bucket_positions[itr->first];
+        cout << itr->first << " " << num_positions << " "
+             << (long) (itr->second / num_positions) << " "
+             << (long) (bucket_requery_micros[itr->first] / num_positions)
+             << endl;
+    }
+
+    // Output the throughput of all the threads together
+    cout << endl;
+    cout << "threads: " << threads.size() << endl;
+    cout << "wall micros: " << (long) wall_micros << endl;
+    cout << "positions per second: "
+         << (long) (corpus.size() / wall_micros * 1e6) << endl;
+
+    if (use_perf)
+    {
+        cout << endl;
+        output_perf_counters(cases, counters);
+        close_perf_counters(counters);
+    }
+
+    MemoryReport report = engine.build_memory_report();
+
+    if (use_cache)
+    {
+        MemoryEntry entry = {"move cache", 0, 0};
+        long long hits = 0, misses = 0;
+
+        for (unsigned int i = 0; i < caches.size(); i++)
+        {
+            entry.bytes += measure_move_cache(caches[i]);
+            entry.count += caches[i].rows.size();
+            hits += caches[i].hits;
+            misses += caches[i].misses;
+        }
+
+        report.push_back(entry);
+
+        cout << endl;
+        cout << "cached rows found: " << hits << endl;
+        cout << "rows searched: " << misses << endl;
+    }
+
+    if (use_move_list)
+    {
+        MemoryEntry entry = {"move lists", 0, 0};
+        long long lines_searched = 0, lines_kept = 0;
+
+        for (unsigned int i = 0; i < move_lists.size(); i++)
+        {
+            entry.bytes += measure_move_list(move_lists[i]);
+            entry.count++;
+            lines_searched += move_lists[i].lines_searched;
+            lines_kept += move_lists[i].lines_kept;
+        }
+
+        report.push_back(entry);
+
+        cout << endl;
+        cout << "lines searched: " << lines_searched << endl;
+        cout << "lines kept: " << lines_kept << endl;
+    }
+
+    MemoryEntry entry = {"search pools", 0, 0};
+
+    for (unsigned int i = 0; i < pools.size(); i++)
+    {
+        entry.bytes += measure_search_pool(pools[i]);
+        entry.count++;
+    }
+
+    report.push_back(entry);
+
+    cout << endl;
+    output_memory_report(report, budget_bytes);
+}
+
+/**
+ * Counts the words of a lexicon by walking every node below a node.
+ *
+ * @param   lexicon     the lexicon to walk
+ * @param   node        the node to start from
+ * @return              the number of words ending at or below the node
+ */
+template <class Lexicon>
+static long long count_lexicon_words (const Lexicon &lexicon,
+                                      typename Lexicon::Node node)
+{
+    long long num_words = lexicon.is_terminal(node) ? 1 : 0;
+    uint32_t mask = lexicon.child_mask(node);
+
+    while (mask != 0)
+    {
+        int letter_index = __builtin_ctz(mask);
+        mask &= mask - 1;
+        num_words += count_lexicon_words(lexicon,
+                                         lexicon.child(node, letter_index));
+    }
+
+    return num_words;
+}
+
+/**
+ * Adds every word below a node of a lexicon to a list, in alphabetical order.
+ *
+ * @param   lexicon     the lexicon to walk
+ * @param   node        the node reached by the letters of word
+ * @param   word        the letters from the root to the node
+ * @param   words       the words found are added to the end
+ */
+template <class Lexicon>
+static void list_lexicon_words (const Lexicon &lexicon,
+                                typename Lexicon::Node node, string &word,
+                                vector <string> &words)
+{
+    if (lexicon.is_terminal(node))
+    {
+        words.push_back(word);
+    }
+
+    for (uint32_t mask = lexicon.child_mask(node); mask != 0; mask &= mask - 1)
+    {
+        int letter_index = __builtin_ctz(mask);
+        word += (char) ('A' + letter_index);
+        list_lexicon_words(lexicon, lexicon.child(node, letter_index), word,
+                           words);
+        word.erase(word.length() - 1);
+    }
+}
+
+/**
+ * @param   lexicon     the lexicon to walk
+ * @param   words       the words that the lexicon should have, in order
+ * @return              true if the lexicon has exactly those words
+ */
+template <class Lexicon>
+static bool has_same_words (const Lexicon &lexicon,
+                            const vector <string> &words)
+{
+    vector <string> lexicon_words;
+    string word;
+    list_lexicon_words(lexicon, lexicon.root(), word, lexicon_words);
+
+    return lexicon_words == words;
+}
+
+/**
+ * @param   lexicon     the lexicon to search
+ * @param   word        a word of uppercase letters
+ * @return              true if the word is in the lexicon
+ */
+template <class Lexicon>
+static bool lexicon_has_word (const Lexicon &lexicon, const string &word)
+{
+    typename Lexicon::Node node = lexicon.root();
+
+    for (unsigned int i = 0; i < word.length(); i++)
+    {
+        node = lexicon.child(node, word[i] - 'A');
+
+        if (node == Lexicon::null_node)
+        {
+            return false;
+        }
+    }
+
+    return lexicon.is_terminal(node);
+}
+
+/**
+ * Counts the words that can be made from a rack by walking a lexicon the way
+ * extend_right does: each child is followed with a tile of its letter and
+ * again with a blank.
+ *
+ * @param   lexicon     the lexicon to walk
+ * @param   node        the node reached by the tiles used so far
+ * @param   rack        the number of each tile left (rack[26] = blanks)
+ * @return              the number of words found, counting each way of
+ *                      making a word with blanks
+ */
+template <class Lexicon>
+static long long count_rack_words (const Lexicon &lexicon,
+                                   typename Lexicon::Node node,
+                                   vector <int> &rack)
+{
+    long long num_words = lexicon.is_terminal(node) ? 1 : 0;
+    uint32_t mask = lexicon.child_mask(node);
+
+    while (mask != 0)
+    {
+        int letter_index = __builtin_ctz(mask);
+        mask &= mask - 1;
+
+        if (rack[letter_index] == 0 && rack[26] == 0)
+        {
+            continue;
+        }
+
+        typename Lexicon::Node child = lexicon.child(node, letter_index);
+
+        if (rack[letter_index] > 0)
+        {
+            rack[letter_index]--;
+            num_words += count_rack_words(lexicon, child, rack);
+            rack[letter_index]++;
+        }
+
+        if (rack[26] > 0)
+        {
+            rack[26]--;
+            num_words += count_rack_words(lexicon, child, rack);
+            rack[26]++;
+        }
+    }
+
+    return num_words;
+}
+
+/**
+ * Times the three ways of walking a lexicon on one encoding and outputs them
+ * as a line of the lexicon benchmark.
+ *
+ * @param   name        the name of the encoding
+ * @param   lexicon     the lexicon to time
+ * @param   num_bytes   the number of bytes used by the lexicon
+ * @param   num_nodes   the number of nodes in the lexicon
+ * @param   words       the words to look up
+ * @param   racks       the racks whose words are counted
+ */
+template <class Lexicon>
+static void time_lexicon (string name, const Lexicon &lexicon,
+                          long long num_bytes, long long num_nodes,
+                          const vector <string> &words,
+                          const vector <vector <int> > &racks)
+{
+    auto start = chrono::steady_clock::now();
+    long long num_words = count_lexicon_words(lexicon, lexicon.root());
+    auto walk_end = chrono::steady_clock::now();
+
+    long long num_found = 0;
+
+    for (unsigned int i = 0; i < words.size(); i++)
+    {
+        num_found += lexicon_has_word(lexicon, words[i]) ? 1 : 0;
+    }
+
+    auto lookup_end = chrono::steady_clock::now();
+
+    long long num_rack_words = 0;
+
+    for (unsigned int i = 0; i < racks.size(); i++)
+    {
+        vector <int> rack = racks[i];
+        num_rack_words += count_rack_words(lexicon, lexicon.root(), rack);
+    }
+
+    auto racks_end = chrono::steady_clock::now();
+
+    cout << name << " " << num_bytes << " " << num_nodes << " "
+         << num_words << " "
+         << chrono::duration_cast <chrono::microseconds>
+                (walk_end - start).count() << " "
+         << num_found << " "
+         << chrono::duration_cast <chrono::microseconds>
+                (lookup_end - walk_end).count() << " "
+         << num_rack_words << " "
+         << chrono::duration_cast <chrono::microseconds>
+                (racks_end - lookup_end).count() << endl;
+}
+
+/**
+ * Compares the memory and the traversal time of each encoding of the engine's
+ * lexicon (see scrabble_lexicon.h). Each encoding is timed walking every
+ * word, looking up every word, and finding the words of every rack of a
+ * corpus. The counts must be the same for every encoding.
+ *
+ * @param   engine      the engine whose lexicon is encoded
+ * @param   file_name   the name of a corpus file created by write_corpus
+ */
+void run_lexicon_benchmark (const Engine &engine, string file_name)
+{
+    vector <CorpusPosition> corpus = read_corpus(file_name);
+    vector <vector <int> > racks;
+
+    for (unsigned int i = 0; i < corpus.size(); i++)
+    {
+        racks.push_back(fill_rack(corpus[i].rack));
+    }
+
+    // The trie only has words longer than 2 letters
+    const AlphagramIndex &index = engine.get_alphagram_index();
+    string word_text (index.word_text, index.word_text_size);
+    vector <string> words;
+    istringstream word_stream (word_text);
+    string word;
+
+    while (getline(word_stream, word))
+    {
+        if (word.length() > 2)
+        {
+            words.push_back(word);
+        }
+    }
+
+    // The pointer graph is built from the words again, and the flat lexicon
+    // is laid out in each order
+    PointerLexicon pointer_lexicon = {create_word_trie(word_text)};
+    long long num_nodes = 0, num_edges = 0, num_bytes = 0;
+    measure_trie(pointer_lexicon.root_node, num_nodes, num_edges, num_bytes);
+
+    // Each flat lexicon points into its lexicon section
+    string flat_sections [3];
+    FlatLexicon flat_lexicons [3];
+
+    for (int i = depth_first_layout; i <= hot_levels_layout; i++)
+    {
+        flat_sections[i] = build_lexicon_section(pointer_lexicon.root_node,
+                                                 (NodeLayout) i);
+        read_lexicon_section(flat_sections[i].data(), flat_sections[i].size(),
+                             flat_lexicons[i]);
+    }
+
+    LoudsLexicon louds_lexicon;
+    build_louds_lexicon(pointer_lexicon.root_node, louds_lexicon);
+
+    cout << "encoding bytes nodes words walk_micros found lookup_micros "
+            "rack_words rack_micros" << endl;
+
+    time_lexicon("pointer", pointer_lexicon, num_bytes, num_nodes, words,
+                 racks);
+
+    for (int i = depth_first_layout; i <= hot_levels_layout; i++)
+    {
+        time_lexicon(string("flat-") + get_layout_name((NodeLayout) i),
+                     flat_lexicons[i], measure_flat_lexicon(flat_lexicons[i]),
+                     flat_lexicons[i].num_nodes, words, racks);
+    }
+
+    time_lexicon("louds", louds_lexicon, measure_louds_lexicon(louds_lexicon),
+                 louds_lexicon.num_nodes, words, racks);
+
+    delete_word_trie((TrieNode*) pointer_lexicon.root_node);
+}
+
+/**
+ * Checks that every encoding of the lexicon (see scrabble_lexicon.h) has
+ * exactly the words of the lexicon that are longer than 2 letters: the
+ * pointer graph, the flat lexicon in each layout, the engine's own flat
+ * lexicon and the LOUDS trie.
+ *
+ * @param   engine  the engine whose lexicon is encoded
+ * @return          the number of encodings whose words differ
+ */
+static int check_lexicon_encodings (const Engine &engine)
+{
+    const AlphagramIndex &index = engine.get_alphagram_index();
+    string word_text (index.word_text, index.word_text_size);
+    vector <string> words;
+    istringstream word_stream (word_text);
+    string word;
+
+    while (getline(word_stream, word))
+    {
+        if (word.length() > 2)
+        {
+            words.push_back(word);
+        }
+    }
+
+    PointerLexicon pointer_lexicon = {create_word_trie(word_text)};
+    int num_checked = 0, num_failed = 0;
+
+    for (int i = depth_first_layout; i <= hot_levels_layout; i++)
+    {
+        string section = build_lexicon_section(pointer_lexicon.root_node,
+                                               (NodeLayout) i);
+        FlatLexicon flat_lexicon;
+        read_lexicon_section(section.data(), section.size(), flat_lexicon);
+
+        num_failed += has_same_words(flat_lexicon, words) ? 0 : 1;
+        num_checked++;
+    }
+
+    LoudsLexicon louds_lexicon;
+    build_louds_lexicon(pointer_lexicon.root_node, louds_lexicon);
+
+    num_failed += has_same_words(pointer_lexicon, words) ? 0 : 1;
+    num_failed += has_same_words(engine.get_lexicon(), words) ? 0 : 1;
+    num_failed += has_same_words(louds_lexicon, words) ? 0 : 1;
+    num_checked += 3;
+
+    delete_word_trie((TrieNode*) pointer_lexicon.root_node);
+
+    cout << "encodings: " << num_checked << " checked, " << num_failed
+         << " failed" << endl;
+
+    return num_failed;
+}
+
+/**
+ * Checks that the best move of each position of a corpus is a legal play of
+ * its rack and that scoring it as a play gives the points of the move.
+ *
+ * @param   engine  the engine to check
+ * @param   corpus  the positions to search
+ * @return          the number of positions whose best move failed
+ */
+static int check_best_moves (const Engine &engine,
+                             const vector <CorpusPosition> &corpus)
+{
+    SquareGrid empty_board = engine.new_board();
+    int num_checked = 0, num_failed = 0;
+
+    for (const CorpusPosition &position : corpus)
+    {
+        SquareGrid board = empty_board;
+        string_to_board(position.letters, board);
+        engine.update_board(board);
+        vector <int> rack = fill_rack(position.rack);
+
+        Move best_move = {};
+        engine.find_best_move(board, rack, best_move);
+
+        if (best_move.num_tiles == 0)
+        {
+            continue;
+        }
+
+        Play play = {best_move.row, best_move.col, best_move.direction,
+                     best_move.length, {0}};
+        memcpy(play.tiles, best_move.tiles, sizeof(play.tiles));
+
+        vector <int> scores;
+        engine.score_plays(board, vector <Play> (1, play), scores);
+        PlayCheck check = engine.validate_play(board, play, rack);
+
+        if (check.error != play_ok || scores[0] != best_move.score)
+        {
+            cout << "best move " << best_move.tiles << " of " << position.rack
+                 << " scores " << scores[0] << " instead of "
+                 << best_move.score << ": " << describe_play_check(check)
+                 << endl;
+            num_failed++;
+        }
+
+        num_checked++;
+    }
+
+    cout << "best moves: " << num_checked << " checked, " << num_failed
+         << " failed" << endl;
+
+    return num_failed;
+}
+
+/**
+ * Checks whether two boards have the same letters, cross-checks and minimum
+ * word lengths on every square.
+ *
+ * @param   board       a board
+ * @param   other_board the board to compare it with
+ * @return              true if every square is the same
+ */
+static bool is_same_board (const SquareGrid &board,
+                           const SquareGrid &other_board)
+{
+    for (size_t i = 0; i < board.size(); i++)
+    {
+        for (size_t j = 0; j < board[i].size(); j++)
+        {
+            const Square &square = board[i][j];
+            const Square &other_square = other_board[i][j];
+
+            if (square.letter != other_square.letter ||
+                square.cross_check_mask != other_square.cross_check_mask ||
+                square.min_across_word_length !=
+                    other_square.min_across_word_length)
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Checks that playing moves with do_move changes a board in the same way as
+ * add_move_to_board and that undoing them restores the board and the racks.
+ * From each position of a corpus, the best move of its rack and then of a few
+ * fixed racks is played, and every move is then undone. Playing a move whose
+ * tiles are not in the rack must change nothing.
+ *
+ * @param   engine  the engine to check
+ * @param   corpus  the positions to play from
+ * @return          the number of moves and positions that failed
+ */
+static int check_do_undo (const Engine &engine,
+                          const vector <CorpusPosition> &corpus)
+{
+    const char* more_racks[] = {"DEGLOOU", "BCEIKMS", "*AELRST"};
+    const int num_racks = 1 + sizeof(more_racks) / sizeof(more_racks[0]);
+    SquareGrid empty_board = engine.new_board();
+    vector <int> empty_rack = fill_rack("");
+    UndoLog log;
+    int num_checked = 0, num_failed = 0;
+
+    for (const CorpusPosition &position : corpus)
+    {
+        SquareGrid board = empty_board;
+        string_to_board(position.letters, board);
+        engine.update_board(board);
+        SquareGrid start_board = board;
+
+        vector <vector <int> > racks (1, fill_rack(position.rack));
+
+        for (int i = 1; i < num_racks; i++)
+        {
+            racks.push_back(fill_rack(more_racks[i - 1]));
+        }
+
+        vector <vector <int> > start_racks = racks;
+        int num_played = 0;
+
+        for (int i = 0; i < num_racks; i++)
+        {
+            Move best_move = {};
+            engine.find_best_move(board, racks[i], best_move);
+
+            if (best_move.num_tiles == 0)
+            {
+                break;
+            }
+
+            // A rack without the move's tiles must leave the board alone
+            SquareGrid played_board = board;
+            vector <int> rack = empty_rack;
+
+            if (engine.do_move(board, rack, best_move, log) ||
+                !is_same_board(board, played_board))
+            {
+                cout << "do_move played " << best_move.tiles
+                     << " from an empty rack" << endl;
+                num_failed++;
+            }
+
+            engine.add_move_to_board(played_board, best_move);
+
+            if (!engine.do_move(board, racks[i], best_move, log) ||
+                !is_same_board(board, played_board))
+            {
+                cout << "do_move of " << best_move.tiles
+                     << " differs from add_move_to_board" << endl;
+                num_failed++;
+            }
+
+            num_played++;
+            num_checked++;
+        }
+
+        for (int i = num_played - 1; i >= 0; i--)
+        {
+            engine.undo_move(board, racks[i], log);
+        }
+
+        if (!is_same_board(board, start_board) || racks != start_racks ||
+            !log.moves.empty() || !log.squares.empty())
+        {
+            cout << "undo_move did not restore the position of "
+                 << position.rack << endl;
+            num_failed++;
+        }
+
+        num_checked++;
+    }
+
+    cout << "do and undo: " << num_checked << " checked, " << num_failed
+         << " failed" << endl;
+
+    return num_failed;
+}
+
+/**
+ * Checks that searching a BoardOverlay finds the same best move as searching
+ * the full board that it stands for. From each position of a corpus, a few
+ * moves are played on an overlay of the position's snapshot and on a copy of
+ * the board, twice over so that the overlay is also reset and reused, and
+ * the snapshot must not be changed by them.
+ *
+ * @param   engine  the engine to check
+ * @param   corpus  the positions to play from
+ * @return          the number of searches and positions that failed
+ */
+static int check_overlay (const Engine &engine,
+                          const vector <CorpusPosition> &corpus)
+{
+    const char* more_racks[] = {"DEGLOOU", "BCEIKMS", "*AELRST", "QZXJKAE"};
+    const int num_racks = sizeof(more_racks) / sizeof(more_racks[0]);
+    const int num_plies = 3;
+    SquareGrid empty_board = engine.new_board();
+    BoardSnapshot snapshot;
+    BoardOverlay overlay;
+    SearchContext context = {};
+    int num_checked = 0, num_failed = 0;
+
+    for (const CorpusPosition &position : corpus)
+    {
+        SquareGrid start_board = empty_board;
+        string_to_board(position.letters, start_board);
+        engine.update_board(start_board);
+        engine.make_snapshot(start_board, snapshot);
+
+        for (int i = 0; i < 2; i++)
+        {
+            reset_overlay(snapshot, overlay);
+            SquareGrid board = start_board;
+
+            for (int j = 0; j < num_plies; j++)
+            {
+                vector <int> rack = (i == 0 && j == 0) ?
+                    fill_rack(position.rack) :
+                    fill_rack(more_racks[(i * num_plies + j) % num_racks]);
+
+                Move overlay_move = {}, best_move = {};
+                engine.find_best_overlay_move(overlay, rack, overlay_move,
+                                              context);
+                engine.find_best_move(board, rack, best_move, context);
+
+                if (overlay_move.score != best_move.score ||
+                    overlay_move.row != best_move.row ||
+                    overlay_move.col != best_move.col ||
+                    overlay_move.direction != best_move.direction ||
+                    strcmp(overlay_move.tiles, best_move.tiles) != 0)
+                {
+                    cout << "overlay move " << overlay_move.tiles << " ("
+                         << overlay_move.score << ") differs from "
+                         << best_move.tiles << " (" << best_move.score
+                         << ")" << endl;
+                    num_failed++;
+                }
+
+                num_checked++;
+
+                if (best_move.num_tiles == 0)
+                {
+                    break;
+                }
+
+                engine.add_move_to_overlay(overlay, best_move);
+                engine.add_move_to_board(board, best_move);
+            }
+        }
+
+        if (!is_same_board(snapshot.boards[ACROSS], start_board))
+        {
+            cout << "the overlay changed the snapshot of " << position.rack
+                 << endl;
+            num_failed++;
+        }
+
+        num_checked++;
+    }
+
+    cout << "overlay: " << num_checked << " checked, " << num_failed
+         << " failed" << endl;
+
+    return num_failed;
+}
+
+/**
+ * Checks on the positions of a corpus that the different ways of storing the
+ * lexicon and the board give the same results. Each check outputs the number
+ * of cases it checked and the number that failed.
+ *
+ * @param   engine      the engine to check
+ * @param   file_name   the name of a corpus file created by write_corpus
+ * @return              true if every check passed
+ */
+bool run_selftest (const Engine &engine, string file_name)
+{
+    // An engine without its words or files would pass every check without
+    // checking anything
+    if (engine.get_num_words() == 0 || !engine.get_load_errors().empty())
+    {
+        cout << "selftest failed: the engine has no words or is missing a file"
+             << endl;
+        return false;
+    }
+
+    vector <CorpusPosition> corpus = read_corpus(file_name);
+    int num_failed = (corpus.empty()) ? 1 : 0;
+
+    num_failed += check_lexicon_encodings(engine);
+    num_failed += check_best_moves(engine, corpus);
+    num_failed += check_do_undo(engine, corpus);
+    num_failed += check_overlay(engine, corpus);
+
+    cout << ((num_failed == 0) ? "selftest passed" : "selftest failed")
+         << endl;
+
+    return num_failed == 0;
+}
+
+/**
+ * Opens the hardware performance counters of the calling thread through
+ * perf_event_open. The counters start disabled. A counter that the CPU or the
+ * kernel does not support has a file descriptor of -1.
+ *
+ * @param   counters    the counters to open. It is passed by reference
+ *                      since its file descriptors are set.
+ * @return              true if at least one counter could be opened
+ */
+bool open_perf_counters (PerfCounters &counters)
+{
+    // The type and config of cycles, instructions, L1 data cache read misses,
+    // last level cache misses and branch mispredicts
+    unsigned int types[NUM_PERF_COUNTERS] =
+        {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+         PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+    unsigned long long configs[NUM_PERF_COUNTERS] =
+        {PERF_COUNT_HW_CPU_CYCLES,
+         PERF_COUNT_HW_INSTRUCTIONS,
+         PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                 | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+         PERF_COUNT_HW_CACHE_MISSES,
+         PERF_COUNT_HW_BRANCH_MISSES};
+    bool any_open = false;
+
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[i];
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        // Count the calling thread on any CPU
+        counters.fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        counters.values[i] = 0;
+
+        if (counters.fds[i] != -1)
+        {
+            any_open = true;
+        }
+    }
+
+    return any_open;
+}
+
+/**
+ * Resets and enables every open counter.
+ *
+ * @param   counters    the counters opened by open_perf_counters
+ */
+void start_perf_counters (PerfCounters &counters)
+{
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        if (counters.fds[i] != -1)
+        {
+            ioctl(counters.fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters.fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/**
+ * Disables every open counter and stores its count in the values property.
+ *
+ * @param   counters    the counters opened by open_perf_counters. It is passed
+ *                      by reference since its values are set.
+ */
+void stop_perf_counters (PerfCounters &counters)
+{
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        counters.values[i] = 0;
+
+        if (counters.fds[i] != -1)
+        {
+            ioctl(counters.fds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+            if (read(counters.fds[i], &counters.values[i],
+                     sizeof(long long)) != sizeof(long long))
+            {
+                counters.values[i] = 0;
+            }
+        }
+    }
+}
+
+/**
+ * Closes every open counter.
+ *
+ * @param   counters    the counters opened by open_perf_counters
+ */
+void close_perf_counters (PerfCounters &counters)
+{
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+    {
+        if (counters.fds[i] != -1)
+        {
+            close(counters.fds[i]);
+            counters.fds[i] = -1;
+        }
+    }
+}
+
+/**
+ * Outputs the hardware counters of every benchmark case divided by the number
+ * of positions and by the number of trie edges visited.
+ *
+ * @param   cases       the totals for each case (density and rack type)
+ * @param   counters    the counters used, to find the unavailable ones
+ */
+void output_perf_counters (map <pair <int, string>, BenchCase> &cases,
+                           PerfCounters &counters)
+{
+    string names[NUM_PERF_COUNTERS] =
+        {"cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+    cout << "PERF COUNTERS" << endl;
+    cout << "target rack_type counter per_position per_edge" << endl;
+
+    for (auto itr = cases.begin(); itr != cases.end(); itr++)
+    {
+        BenchCase &bench_case = itr->second;
+
+        for (int i = 0; i < NUM_PERF_COUNTERS; i++)
+        {
+            cout << itr->first.first << " " << itr->first.second << " "
+                 << names[i] << " ";
+
+            if (counters.fds[i] == -1)
+            {
+                cout << "n/a n/a" << endl;
+                continue;
+            }
+
+            double total = bench_case.counters[i];
+            cout << total / bench_case.positions << " "
+                 << total / max(bench_case.trie_edges, 1LL) << endl;
+        }
+    }
+}
+
+/**
+ * @return  the peak resident set size of the process in bytes
+ */
+long long get_peak_rss ()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    // Linux reports ru_maxrss in kilobytes
+    return (long long) usage.ru_maxrss * 1024;
+}
+
+/**
+ * @return  the bytes of the process's resident anonymous pages (its heap and
+ *          stacks), which unlike a mapped lexicon image are not shared with
+ *          other processes, or -1 if they could not be read
+ */
+long long get_private_rss ()
+{
+    // Linux reports RssAnon in kilobytes
+    ifstream status_file ("/proc/self/status");
+    string line;
+
+    while (getline(status_file, line))
+    {
+        if (line.compare(0, 8, "RssAnon:") == 0)
+        {
+            return atoll(line.c_str() + 8) * 1024;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Outputs every entry of a memory report, the total, the peak resident set
+ * size and the resident set size that is not shared. Outputs a warning if the
+ * budget has been exceeded.
+ *
+ * @param   report          the entries created by build_memory_report
+ * @param   budget_bytes    the memory budget or 0 if there is no budget
+ */
+void output_memory_report (MemoryReport &report, long long budget_bytes)
+{
+    long long total_bytes = 0;
+
+    cout << "MEMORY" << endl;
+
+    for (unsigned int i = 0; i < report.size(); i++)
+    {
+        cout << report[i].name << ": " << report[i].bytes << " bytes ("
+             << report[i].count << ")" << endl;
+        total_bytes += report[i].bytes;
+    }
+
+    long long peak_rss = get_peak_rss();
+    cout << "total: " << total_bytes << " bytes" << endl;
+    cout << "peak rss: " << peak_rss << " bytes" << endl;
+    cout << "private rss: " << get_private_rss() << " bytes" << endl;
+
+    if (budget_bytes > 0 && max(total_bytes, peak_rss) > budget_bytes)
+    {
+        cout << "WARNING: memory budget of " << budget_bytes
+             << " bytes exceeded" << endl;
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * scrabble_bench.h
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Generates a corpus of positions by having an engine play against
+ *          itself, times the engine on every position of a corpus, and
+ *          checks that the engine gives the same results on them however
+ *          the lexicon and the board are stored.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#ifndef SCRABBLE_BENCH_H
+#define SCRABBLE_BENCH_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <atomic>
+#include "scrabble_engine.h"
+
+#define CORPUS_FILE_NAME "corpus.txt"
+#define NUM_PERF_COUNTERS 5
+
+using namespace std;
+
+// A position of a synthetic game used for benchmarking and regressions
+struct CorpusPosition
+{
+    int target_tiles;   // The density bucket (ex. 10, 40, 70 or 90 tiles)
+    int num_tiles;      // The actual number of tiles on the board
+    string rack_type;   // "balanced", "blank" or "vowel"
+    string rack;        // Uppercase letters with '*' for blank tiles
+    string letters;     // All the board's letters, row by row
+};
+
+// The hardware performance counters read during the benchmark
+struct PerfCounters
+{
+    int fds[NUM_PERF_COUNTERS];             // -1 if a counter is unavailable
+    long long values[NUM_PERF_COUNTERS];
+};
+
+// The totals of the benchmark for one density bucket and rack type
+struct BenchCase
+{
+    int positions;
+    long long trie_edges;
+    long long counters[NUM_PERF_COUNTERS];
+};
+
+// The result of the benchmark for one position
+struct BenchResult
+{
+    int best_pts;
+    long long trie_edges;
+    double micros;
+    double requery_micros;  // The time to search again after the best move
+    long long counters[NUM_PERF_COUNTERS];
+};
+
+// Declare functions
+string fill_bag (const Engine &engine);
+string draw_tiles (string &bag, int num_tiles, string wanted, mt19937 &rng);
+string draw_rack_of_type (string pool, string rack_type, mt19937 &rng);
+vector <CorpusPosition> generate_corpus (const Engine &engine,
+                                         unsigned int seed, int num_games);
+bool write_corpus (vector <CorpusPosition> &corpus, unsigned int seed,
+                   string file_name);
+vector <CorpusPosition> read_corpus (string file_name);
+void benchmark_positions (const Engine &engine,
+                          const vector <CorpusPosition> &corpus,
+                          atomic <unsigned int> &next_position,
+                          vector <BenchResult> &results, bool use_perf,
+                          MoveCache* cache, MoveList* moves, SearchPool* pool);
+void run_benchmark (const Engine &engine, string file_name,
+                    long long budget_bytes, bool use_perf, int num_threads,
+                    bool use_cache, bool use_move_list);
+void run_lexicon_benchmark (const Engine &engine, string file_name);
+bool run_selftest (const Engine &engine, string file_name);
+bool open_perf_counters (PerfCounters &counters);
+void start_perf_counters (PerfCounters &counters);
+void stop_perf_counters (PerfCounters &counters);
+void close_perf_counters (PerfCounters &counters);
+void output_perf_counters (map <pair <int, string>, BenchCase> &cases,
+                           PerfCounters &counters);
+long long get_peak_rss ();
+long long get_private_rss ();
+void output_memory_report (MemoryReport &report, long long budget_bytes);
+
+#endif
@@ -0,0 +1,267 @@
+/**
+ * scrabble_c.cpp
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Implements the C interface to the engine declared in scrabble_c.h.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include "scrabble_c.h"
+#include "scrabble_engine.h"
+
+struct scrabble_engine
+{
+    Engine* engine;
+};
+
+/**
+ * Fills in a board from a string of letters given through the C interface.
+ *
+ * @param   letters     the board's letters, row by row
+ * @param   board       the board to fill in. It is passed by reference since
+ *                      it is modified.
+ * @return              true if the letters were a valid board
+ */
+static bool read_c_board (const char* letters, SquareGrid &board)
+{
+    int num_squares = NUM_BOARD_ROWS * NUM_BOARD_COLS;
+
+    // Ensure the string is exactly one letter per square
+    if (letters == NULL || memchr(letters, '\0', num_squares) != NULL ||
+        letters[num_squares] != '\0')
+    {
+        return false;
+    }
+
+    for (int i = 0; i < num_squares; i++)
+    {
+        if (letters[i] != '.' && !isalpha((unsigned char) letters[i]))
+        {
+            return false;
+        }
+    }
+
+    // The letters are copied straight into the board rather than through a
+    // string, so that a batch does not allocate for each position
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            board[row][col].letter = letters[(row-1)*NUM_BOARD_COLS + col-1];
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Converts a move found by the engine into a move of the C interface.
+ *
+ * @param   _move       the move found by the engine
+ * @param   c_move      the move to fill in
+ */
+static void write_c_move (const Move &_move, scrabble_move* c_move)
+{
+    memset(c_move, 0, sizeof(scrabble_move));
+    c_move->score = -1;
+
+    if (_move.num_tiles == 0)
+    {
+        return;
+    }
+
+    c_move->score = _move.score;
+    c_move->row = _move.row;
+    c_move->col = _move.col;
+    c_move->direction = (_move.direction == DOWN) ? SCRABBLE_DOWN :
+                                                    SCRABBLE_ACROSS;
+    c_move->length = _move.length;
+    memcpy(c_move->tiles, _move.tiles, _move.length);
+}
+
+/**
+ * Converts a move of the C interface into a Play.
+ *
+ * @param   c_move      the move to convert
+ * @param   play        the play to fill in
+ */
+static void read_c_move (const scrabble_move* c_move, Play &play)
+{
+    play.row = c_move->row;
+    play.col = c_move->col;
+    play.direction = c_move->direction;
+    play.length = min((int) c_move->length, NUM_BOARD_COLS);
+    memcpy(play.tiles, c_move->tiles, play.length);
+}
+
+scrabble_engine* scrabble_engine_create (const char* lexicon_file,
+                                         const char* tiles_file,
+                                         const char* board_file)
+{
+    scrabble_engine* c_engine = new scrabble_engine;
+    c_engine->engine = new Engine(lexicon_file ? lexicon_file : WORDS_FILE_NAME,
+                                  tiles_file ? tiles_file : TILES_FILE_NAME,
+                                  board_file ? board_file : BOARD_FILE_NAME);
+
+    // An engine that is missing its words, tiles or board layout would find
+    // no moves (or read past the end of its board), so it is not returned
+    if (c_engine->engine->get_num_words() == 0 ||
+        !c_engine->engine->get_load_errors().empty() ||
+        c_engine->engine->get_tiles().empty() ||
+        c_engine->engine->new_board().empty())
+    {
+        scrabble_engine_free(c_engine);
+        return NULL;
+    }
+
+    return c_engine;
+}
+
+void scrabble_engine_free (scrabble_engine* engine)
+{
+    if (engine != NULL)
+    {
+        delete engine->engine;
+        delete engine;
+    }
+}
+
+int scrabble_engine_is_current (const scrabble_engine* engine)
+{
+    return engine->engine->is_lexicon_current() ? 1 : 0;
+}
+
+size_t scrabble_analyze_positions (const scrabble_engine* engine,
+                                   const scrabble_position* positions,
+                                   size_t num_positions,
+                                   scrabble_move* best_moves)
+{
+    const Engine &cpp_engine = *engine->engine;
+    size_t num_valid = 0;
+
+    // The board, rack, move and search state are reused for every position,
+    // so the batch allocates only until they have grown. The positions of a
+    // batch are often from the same game, so the best move of each row and
+    // column of the previous position is kept in a MoveList, and only the
+    // lines that changed since the previous position are searched when its
+    // rack is the same. No MoveCache is used, since it allocates a key for
+    // each new row.
+    SquareGrid empty_board = cpp_engine.new_board();
+    SquareGrid board = empty_board;
+    vector <int> rack;
+    MoveList moves;
+    SearchPool pool;
+    SearchContext context = {};
+    context.pool = &pool;
+
+    for (size_t i = 0; i < num_positions; i++)
+    {
+        board = empty_board;
+        memset(&best_moves[i], 0, sizeof(scrabble_move));
+        best_moves[i].score = -1;
+
+        if (positions[i].rack == NULL ||
+            !read_c_board(positions[i].letters, board))
+        {
+            continue;
+        }
+
+        fill_rack(positions[i].rack, rack);
+        cpp_engine.update_move_list(board, rack, moves, context);
+        write_c_move(moves.best_move, &best_moves[i]);
+        num_valid++;
+    }
+
+    return num_valid;
+}
+
+size_t scrabble_score_moves (const scrabble_engine* engine,
+                             const char* letters,
+                             const scrabble_move* moves,
+                             size_t num_moves,
+                             int32_t* scores)
+{
+    const Engine &cpp_engine = *engine->engine;
+    SquareGrid board = cpp_engine.new_board();
+    size_t num_valid = 0;
+
+    if (!read_c_board(letters, board))
+    {
+        for (size_t i = 0; i < num_moves; i++)
+        {
+            scores[i] = -1;
+        }
+
+        return 0;
+    }
+
+    // Build the score table once and share it between every move
+    ScoreTable table;
+    cpp_engine.build_score_table(board, table);
+
+    for (size_t i = 0; i < num_moves; i++)
+    {
+        Play play;
+        read_c_move(&moves[i], play);
+
+        scores[i] = cpp_engine.score_play(table, play);
+
+        if (scores[i] != -1)
+        {
+            num_valid++;
+        }
+    }
+
+    return num_valid;
+}
+
+size_t scrabble_validate_moves (const scrabble_engine* engine,
+                                const char* letters,
+                                const char* rack,
+                                const scrabble_move* moves,
+                                size_t num_moves,
+                                int32_t* errors)
+{
+    const Engine &cpp_engine = *engine->engine;
+    SquareGrid board = cpp_engine.new_board();
+    size_t num_valid = 0;
+
+    if (rack == NULL || !read_c_board(letters, board))
+    {
+        for (size_t i = 0; i < num_moves; i++)
+        {
+            errors[i] = SCRABBLE_OFF_BOARD;
+        }
+
+        return 0;
+    }
+
+    // Update the cross-checks once and share them between every move
+    cpp_engine.update_board(board);
+    vector <int> cpp_rack = fill_rack(rack);
+
+    for (size_t i = 0; i < num_moves; i++)
+    {
+        Play play;
+        read_c_move(&moves[i], play);
+
+        errors[i] = cpp_engine.validate_play(board, play, cpp_rack).error;
+
+        if (errors[i] == SCRABBLE_OK)
+        {
+            num_valid++;
+        }
+    }
+
+    return num_valid;
+}
+
+const char* scrabble_error_message (int32_t error)
+{
+    return play_error_message((PlayError) error);
+}
@@ -0,0 +1,123 @@
+/**
+ * scrabble_c.h
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: A C interface to the engine for programs that are not written in
+ *          C++. Many positions or moves are passed in one call, and the results
+ *          are written to arrays provided by the caller, so no memory needs to
+ *          be freed other than the engine itself.
+ *
+ *          A board is a string of 15 * 15 letters, row by row, where '.' is an
+ *          empty square and a lowercase letter is a blank tile. A rack is a
+ *          string of up to 7 uppercase letters where '*' is a blank tile.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#ifndef SCRABBLE_C_H
+#define SCRABBLE_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SCRABBLE_ACROSS 0
+#define SCRABBLE_DOWN 1
+#define SCRABBLE_MAX_TILES 15
+
+/* Why a move is not legal (see scrabble_validate_moves) */
+#define SCRABBLE_OK 0
+#define SCRABBLE_OFF_BOARD 1
+#define SCRABBLE_BAD_LETTER 2
+#define SCRABBLE_ON_TILE 3
+#define SCRABBLE_NOT_CONTIGUOUS 4
+#define SCRABBLE_NO_TILES 5
+#define SCRABBLE_NOT_IN_RACK 6
+#define SCRABBLE_NOT_CONNECTED 7
+#define SCRABBLE_NOT_ON_CENTRE 8
+#define SCRABBLE_TOO_SHORT 9
+#define SCRABBLE_BAD_MAIN_WORD 10
+#define SCRABBLE_BAD_CROSS_WORD 11
+
+typedef struct scrabble_engine scrabble_engine;
+
+typedef struct scrabble_position
+{
+    const char* letters;    /* The board's letters, row by row */
+    const char* rack;       /* The tiles in the rack */
+} scrabble_position;
+
+typedef struct scrabble_move
+{
+    int32_t score;          /* -1 if there is no move or the move is invalid */
+    uint8_t row;            /* The row of the first tile placed (1 to 15) */
+    uint8_t col;            /* The column of the first tile placed (1 to 15) */
+    uint8_t direction;      /* SCRABBLE_ACROSS or SCRABBLE_DOWN */
+    uint8_t length;         /* The number of squares in tiles */
+
+    /* The letter placed on each square from the first tile placed to the last
+       tile placed, where '.' is a square that already has a tile and a
+       lowercase letter is a blank tile. Ends with '\0'. */
+    char tiles[SCRABBLE_MAX_TILES + 1];
+} scrabble_move;
+
+/* Creates an engine from a lexicon image (or a text file of words), a tiles
+   file and a board file. NULL uses the default file. Returns NULL if any of
+   the files could not be read or the lexicon has no words. A lexicon image
+   is mapped rather than copied, so the engines of every process that uses
+   the same file share its memory. */
+scrabble_engine* scrabble_engine_create (const char* lexicon_file,
+                                         const char* tiles_file,
+                                         const char* board_file);
+
+/* Frees an engine created by scrabble_engine_create. */
+void scrabble_engine_free (scrabble_engine* engine);
+
+/* Returns 0 if the engine was created from a lexicon image file and another
+   image has since been written to that file, and 1 otherwise. The engine
+   keeps using the image it mapped, so a worker can create an engine with the
+   new image between requests and then free the old one. */
+int scrabble_engine_is_current (const scrabble_engine* engine);
+
+/* Finds the best move of each position and writes it to best_moves, which
+   must have room for num_positions moves. Returns the number of positions
+   that were valid. A position with the same rack as the one before it is
+   found faster when only a few of their tiles differ. */
+size_t scrabble_analyze_positions (const scrabble_engine* engine,
+                                   const scrabble_position* positions,
+                                   size_t num_positions,
+                                   scrabble_move* best_moves);
+
+/* Scores each move as if it were played on the board and writes the score to
+   scores, which must have room for num_moves scores. The score property of
+   the moves is ignored. Returns the number of moves that were valid. */
+size_t scrabble_score_moves (const scrabble_engine* engine,
+                             const char* letters,
+                             const scrabble_move* moves,
+                             size_t num_moves,
+                             int32_t* scores);
+
+/* Checks whether each move can be played on the board with the rack and
+   writes SCRABBLE_OK or the reason it cannot to errors, which must have room
+   for num_moves errors. The score property of the moves is ignored. If the
+   board or rack is not valid, every error is SCRABBLE_OFF_BOARD. Returns the
+   number of moves that were legal. */
+size_t scrabble_validate_moves (const scrabble_engine* engine,
+                                const char* letters,
+                                const char* rack,
+                                const scrabble_move* moves,
+                                size_t num_moves,
+                                int32_t* errors);
+
+/* Gets a description of an error written by scrabble_validate_moves. */
+const char* scrabble_error_message (int32_t error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
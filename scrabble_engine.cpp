@@ -0,0 +1,3602 @@
+/**
+ * scrabble_engine.cpp
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: I created this project for the IB English Scrabble tournament.
+ *          It uses a variant of Appel and Jacobson's algorithm to create a
+ *          computer program that can play scrabble. The algorithm is simplified
+ *          since it uses a trie rather than a dawg.
+ *
+ * References: https://pdfs.semanticscholar.org/da31/
+ *                  cb24574f7c881a5dbf008e52aac7048c9d9c.pdf
+ *             https://web.stanford.edu/class/cs221/2017/restricted/p-final/
+ *                  cajoseph/final.pdf
+ *
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <regex>
+#include <cctype>
+#include <algorithm>
+#include <unordered_set>
+#include "scrabble_engine.h"
+#include "scrabble_image.h"
+#include "scrabble_trace.h"
+
+/**
+ * Reads the words, tiles and board layout from text files. The words can also
+ * be read from a lexicon image, which is mapped and used in place.
+ *
+ * @param   words_file_name     the name of the file containing the words
+ * @param   tiles_file_name     the name of the file containing the tiles
+ * @param   board_file_name     the name of the file containing the board layout
+ */
+Engine::Engine (string words_file_name, string tiles_file_name,
+                string board_file_name)
+{
+    bool is_image = is_lexicon_image(words_file_name);
+    string error;
+
+    if (is_image && !read_lexicon_image(words_file_name, image, error))
+    {
+        load_errors += error + "\n";
+    }
+    else if (is_image && !read_lexicon_tables())
+    {
+        load_errors += words_file_name + " has invalid sections\n";
+    }
+
+    // A text file of words (or an image that could not be read, which gives
+    // an engine without words) is made into an image in memory. If its
+    // tables cannot be read either, the engine is left without words rather
+    // than without tables.
+    if (alphagrams.word_text == NULL)
+    {
+        build_lexicon_image(is_image ? "" : read_word_data(words_file_name));
+
+        if (!read_lexicon_tables())
+        {
+            load_errors += "Could not index the words of " + words_file_name
+                           + "\n";
+            build_lexicon_image("");
+            read_lexicon_tables();
+        }
+    }
+
+    tiles = read_tile_data(tiles_file_name);
+    layout = read_board_data(board_file_name);
+
+    for (int i = 0; i < 128; i++)
+    {
+        letter_pts[i] = (isupper(i) && i - 'A' < (int) tiles.size()) ?
+                        tiles[i - 'A'].points : 0;
+    }
+}
+
+/**
+ * @return  an empty board with the layout read from the board file
+ */
+SquareGrid Engine::new_board () const
+{
+    return layout;
+}
+
+/**
+ * @return  the tiles read from the tiles file
+ */
+const vector <Tile> &Engine::get_tiles () const
+{
+    return tiles;
+}
+
+/**
+ * @param   word    a string of uppercase letters
+ * @return          true if the word is in the lexicon
+ */
+bool Engine::is_word (string word) const
+{
+    return find_alphagram_word(alphagrams, word) != NO_ALPHAGRAM_WORD;
+}
+
+/**
+ * @return  the number of words in the lexicon
+ */
+size_t Engine::get_num_words () const
+{
+    return alphagrams.num_words;
+}
+
+/**
+ * @return  the word graph of the words longer than 2 letters
+ */
+const FlatLexicon &Engine::get_lexicon () const
+{
+    return lexicon;
+}
+
+/**
+ * @return  what the words below each node of the word graph have in common,
+ *          in the order of the graph's nodes
+ */
+const BranchSummary* Engine::get_branches () const
+{
+    return branches;
+}
+
+/**
+ * @return  the index from alphagrams to the words of the lexicon
+ */
+const AlphagramIndex &Engine::get_alphagram_index () const
+{
+    return alphagrams;
+}
+
+/**
+ * @param   fragment    a word or a single letter in uppercase
+ * @return              the letters that can be put before and after the
+ *                      fragment to make a word (none if it is not a word)
+ */
+WordHooks Engine::get_hooks (const string &fragment) const
+{
+    WordHooks no_hooks = {0, 0};
+
+    if (fragment.length() == 1)
+    {
+        return isupper(fragment[0]) ? hooks[fragment[0] - 'A'] : no_hooks;
+    }
+
+    uint32_t position = find_alphagram_word(alphagrams, fragment);
+    return (position != NO_ALPHAGRAM_WORD) ? hooks[26 + position] : no_hooks;
+}
+
+/**
+ * Writes the words of the lexicon in sorted order, the alphagram index, the
+ * hook tables, the word graph and its branch summaries to a lexicon image,
+ * which can be read back faster than a text file.
+ *
+ * @param   file_name   the name of the lexicon image file to create
+ * @param   layout      the order of the nodes of the word graph
+ * @param   error       set to the reason if the image could not be written
+ * @return              true if the image was written
+ */
+bool Engine::save_lexicon_image (string file_name, NodeLayout layout,
+                                 string &error) const
+{
+    // The words of the alphagram index are already sorted
+    string word_text (alphagrams.word_text, alphagrams.word_text_size);
+    map <uint32_t, string> sections;
+    sections[words_section] = word_text;
+    sections[alphagram_section] = write_alphagram_section(alphagrams);
+    sections[hooks_section] = string((const char*) hooks,
+                                     (26 + alphagrams.num_words)
+                                     * sizeof(WordHooks));
+
+    if (layout == lexicon.layout)
+    {
+        sections[lexicon_section] = write_lexicon_section(lexicon);
+        sections[branch_section] = string((const char*) branches,
+                                          lexicon.num_nodes
+                                          * sizeof(BranchSummary));
+    }
+    else
+    {
+        // The branch summaries are in the order of the new layout's nodes
+        TrieNode* root = create_word_trie(word_text);
+        sections[lexicon_section] = build_lexicon_section(root, layout);
+        delete_word_trie(root);
+
+        FlatLexicon new_lexicon;
+        read_lexicon_section(sections[lexicon_section].data(),
+                             sections[lexicon_section].size(), new_lexicon);
+        sections[branch_section] = build_branch_section(new_lexicon);
+    }
+
+    return write_lexicon_image(file_name, sections, error);
+}
+
+/**
+ * @return  false if the lexicon was mapped from a lexicon image file that has
+ *          since been replaced by another image, in which case a new engine
+ *          can be created to use the new image
+ */
+bool Engine::is_lexicon_current () const
+{
+    return is_lexicon_image_current(image);
+}
+
+/**
+ * @return  a line for each file that could not be read when the engine was
+ *          constructed, or "" if every file was read
+ */
+const string &Engine::get_load_errors () const
+{
+    return load_errors;
+}
+
+/**
+ * Updates the cross-checks and minimum word lengths of every square after
+ * tiles have been added to or removed from the board.
+ *
+ * @param   board   a SquareGrid containing the data for the state of the game
+ *                  This parameter is passed by reference since the board is
+ *                  being modified.
+ */
+void Engine::update_board (SquareGrid &board) const
+{
+    update_down_cross_checks(board);
+    update_min_across_word_length(board);
+}
+
+/**
+ * @param   file_name   the name of a text file containing the words
+ * @return  every word in sorted order, each ending in '\n'
+ */
+string Engine::read_word_data (string file_name)
+{
+    // Declare vector to store all of the words in the scrabble dictionary
+    vector <string> sorted_words;
+
+    // Open file containing the word data
+    ifstream word_data_file;
+    word_data_file.open(file_name.c_str(), ifstream::in);
+
+    // Ensure data file is open
+    if (!word_data_file.is_open())
+    {
+        load_errors += "Could not open " + file_name + "\n";
+        return "";
+    }
+
+    // Loop through all the words and add them to the vector
+    while (word_data_file.good())
+    {
+        // IMPORTANT: The words must all be in uppercase.
+        string word;
+        word_data_file >> word;
+
+        if (word.length() > 0)
+        {
+            sorted_words.push_back(word);
+        }
+    }
+
+    sort(sorted_words.begin(), sorted_words.end());
+    sorted_words.erase(unique(sorted_words.begin(), sorted_words.end()),
+                       sorted_words.end());
+
+    string word_text;
+
+    for (unsigned int i = 0; i < sorted_words.size(); i++)
+    {
+        word_text += sorted_words[i] + '\n';
+    }
+
+    return word_text;
+}
+
+/**
+ * Finds the hooks of every letter and word of an alphagram index.
+ *
+ * Every word of 2 or more letters is a back hook of the word (or letter) made
+ * by its first letters and a front hook of the one made by its last letters,
+ * so the hooks are found with two lookups per word.
+ *
+ * @param   index   the alphagram index of the words
+ * @return          the bytes of the hooks section of a lexicon image
+ */
+static string build_hooks_section (const AlphagramIndex &index)
+{
+    WordHooks no_hooks = {0, 0};
+    vector <WordHooks> hooks (26 + index.num_words, no_hooks);
+    size_t word_start = 0;
+
+    for (size_t i = 0; i < index.word_text_size; i++)
+    {
+        if (index.word_text[i] != '\n')
+        {
+            continue;
+        }
+
+        string word (index.word_text + word_start, i - word_start);
+        int length = word.length();
+        word_start = i + 1;
+
+        if (length < 2 || !isupper(word[0]) || !isupper(word[length-1]))
+        {
+            continue;
+        }
+
+        string before = word.substr(0, length - 1);
+        string after = word.substr(1);
+
+        if (length == 2 && isupper(before[0]))
+        {
+            hooks[before[0] - 'A'].back |= 1 << (word[1] - 'A');
+        }
+        else
+        {
+            uint32_t position = find_alphagram_word(index, before);
+
+            if (position != NO_ALPHAGRAM_WORD)
+            {
+                hooks[26 + position].back |= 1 << (word[length-1] - 'A');
+            }
+        }
+
+        if (length == 2 && isupper(after[0]))
+        {
+            hooks[after[0] - 'A'].front |= 1 << (word[0] - 'A');
+        }
+        else
+        {
+            uint32_t position = find_alphagram_word(index, after);
+
+            if (position != NO_ALPHAGRAM_WORD)
+            {
+                hooks[26 + position].front |= 1 << (word[0] - 'A');
+            }
+        }
+    }
+
+    return string((const char*) hooks.data(), hooks.size() * sizeof(WordHooks));
+}
+
+/**
+ * Makes a lexicon image in memory with the alphagram index, the hook tables,
+ * the word graph and its branch summaries of a list of words, for words read
+ * from a text file.
+ *
+ * @param   word_text   every word in sorted order, each ending in '\n'
+ */
+void Engine::build_lexicon_image (const string &word_text)
+{
+    map <uint32_t, string> sections;
+    sections[words_section] = word_text;
+    sections[alphagram_section] = build_alphagram_section(word_text);
+
+    // The hooks are numbered by the alphagram index, which is read from its
+    // section to find them
+    AlphagramIndex index;
+    read_alphagram_section(sections[alphagram_section].data(),
+                           sections[alphagram_section].size(),
+                           word_text.data(), word_text.size(), index);
+    sections[hooks_section] = build_hooks_section(index);
+
+    TrieNode* root = create_word_trie(word_text);
+    sections[lexicon_section] = build_lexicon_section(root, hot_levels_layout);
+    delete_word_trie(root);
+
+    FlatLexicon new_lexicon;
+    read_lexicon_section(sections[lexicon_section].data(),
+                         sections[lexicon_section].size(), new_lexicon);
+    sections[branch_section] = build_branch_section(new_lexicon);
+
+    make_lexicon_image(sections, image);
+}
+
+/**
+ * Points the alphagram index, the hook tables, the word graph and its branch
+ * summaries at their sections of the engine's lexicon image.
+ *
+ * @return  true if the image had every section and they were valid
+ */
+bool Engine::read_lexicon_tables ()
+{
+    uint64_t words_size = 0, alphagram_size = 0, hooks_size = 0;
+    uint64_t lexicon_size = 0, branch_size = 0;
+    const char* words_data = find_image_section(image, words_section,
+                                                words_size);
+    const char* alphagram_data = find_image_section(image, alphagram_section,
+                                                    alphagram_size);
+    const char* hooks_data = find_image_section(image, hooks_section,
+                                                hooks_size);
+    const char* lexicon_data = find_image_section(image, lexicon_section,
+                                                  lexicon_size);
+    const char* branch_data = find_image_section(image, branch_section,
+                                                 branch_size);
+
+    if (!read_alphagram_section(alphagram_data, alphagram_size, words_data,
+                                words_size, alphagrams) ||
+        hooks_data == NULL ||
+        hooks_size != (26 + alphagrams.num_words) * sizeof(WordHooks) ||
+        !read_lexicon_section(lexicon_data, lexicon_size, lexicon) ||
+        !read_branch_section(branch_data, branch_size, lexicon, branches))
+    {
+        alphagrams = AlphagramIndex();
+        lexicon = FlatLexicon();
+        branches = NULL;
+        return false;
+    }
+
+    hooks = (const WordHooks*) hooks_data;
+    return true;
+}
+
+/**
+ * Replaces a node by an equivalent node that has already been registered, or
+ * registers it if there is none. Two nodes are equivalent if they have the
+ * same letter, are both terminal or not, and have the same children. Since
+ * the children of a node are registered before it is, equivalent children
+ * are the same nodes.
+ *
+ * @param   parent      the parent of the node
+ * @param   node        the node, which is the last child of its parent
+ * @param   registry    the registered nodes, by letter, terminal and children
+ */
+static void replace_or_register (TrieNode* parent, TrieNode* node,
+                                 unordered_map <string, TrieNode*> &registry)
+{
+    string key;
+    key += node->letter;
+    key += (char) node->is_terminal_node;
+    key.append((const char*) node->children.data(),
+               node->children.size() * sizeof(TrieNode*));
+
+    auto itr = registry.find(key);
+
+    if (itr == registry.end())
+    {
+        // The node's children will not change, so free their spare room
+        node->children.shrink_to_fit();
+        registry[key] = node;
+        return;
+    }
+
+    parent->children.back() = itr->second;
+    delete node;
+}
+
+/**
+ * Builds a minimized word graph (a DAWG) of the words longer than 2 letters.
+ * It is walked in the same way as a trie, but words with the same endings
+ * (ex. -ING, -NESS) share the nodes of their endings.
+ *
+ * The words are added in sorted order, so once a word has been added, the
+ * nodes of the previous word that are not part of it will not change. Those
+ * nodes are then merged with equivalent nodes from the deepest one up
+ * (Daciuk et al., "Incremental Construction of Minimal Acyclic Finite-State
+ * Automata", 2000). The graph is freed with delete_word_trie.
+ *
+ * @param   word_text   every word in sorted order, each ending in '\n'
+ * @return              a pointer to a TrieNode that is the root of the graph
+ */
+TrieNode* create_word_trie (const string &word_text)
+{
+    TrieNode* root = new TrieNode;
+    root->letter = '*';
+    root->is_terminal_node = false;
+    regex all_uppercase ("[A-Z]+");
+
+    unordered_map <string, TrieNode*> registry;
+
+    // The nodes of the previous word added, where path[i] is the node
+    // reached after i letters
+    vector <TrieNode*> path (1, root);
+    string prev_word;
+
+    size_t word_start = 0;
+
+    for (size_t i = 0; i < word_text.length(); i++)
+    {
+        if (word_text[i] != '\n')
+        {
+            continue;
+        }
+
+        string str = word_text.substr(word_start, i - word_start);
+        word_start = i + 1;
+
+        if (str.length() <= 2 || !regex_match(str, all_uppercase))
+        {
+            continue;
+        }
+
+        // Find the letters that the word shares with the previous word
+        unsigned int prefix_length = 0;
+
+        while (prefix_length < str.length() &&
+               prefix_length < prev_word.length() &&
+               str[prefix_length] == prev_word[prefix_length])
+        {
+            prefix_length++;
+        }
+
+        // Merge the rest of the previous word's nodes
+        for (unsigned int depth = path.size() - 1; depth > prefix_length;
+             depth--)
+        {
+            replace_or_register(path[depth - 1], path[depth], registry);
+        }
+
+        path.resize(prefix_length + 1);
+
+        // Add the rest of the word as new nodes
+        for (unsigned int j = prefix_length; j < str.length(); j++)
+        {
+            TrieNode* new_node = new TrieNode;
+            new_node->letter = str[j];
+            new_node->is_terminal_node = false;
+
+            path[j]->children.push_back(new_node);
+            path[j]->letter_indexes[str[j] - 'A'] =
+                                            path[j]->children.size() - 1;
+            path.push_back(new_node);
+        }
+
+        path.back()->is_terminal_node = true;
+        prev_word = str;
+    }
+
+    for (unsigned int depth = path.size() - 1; depth > 0; depth--)
+    {
+        replace_or_register(path[depth - 1], path[depth], registry);
+    }
+
+    return root;
+}
+
+/**
+ * Inserts TrieNodes into the trie to store the word in the data structure.
+ *
+ * @param   root    a pointer a TrieNode that is the root of the trie
+ * @param   words   the string of letters to be inserted
+ */
+void insert_into_trie (TrieNode* root, string word)
+{
+    TrieNode* curr_node = root;
+
+    // Go through each letter in the word -> each letter is word[i]
+    for (unsigned int i = 0; i < word.length(); i++)
+    {
+        // Calculate the index for the letter_indexes property
+        // for the letter in the word
+        // letter_index allows the program to determine whether a
+        // child has the letter word[i] in O(1) time
+        int letter_index = word[i] - 'A';
+
+        // Check to see if there are no children with the letter in the word
+        if (curr_node->letter_indexes[letter_index] == -1)
+        {
+            // Create a new node
+            TrieNode* new_node = new TrieNode;
+            new_node->letter = word[i];
+            new_node->is_terminal_node = false;
+
+            // Update the current node by adding new_node as a child
+            curr_node->children.push_back(new_node);
+
+            // Also, update the letter_indexes property by storing
+            // the index of the child where the letter word[i] can be found
+            // It is the index of the last child in the children property
+            // since the node was just added
+            curr_node->letter_indexes[letter_index] =
+                                            curr_node->children.size() - 1;
+        }
+
+        // Go to the child of curr_node that contains the letter in the word
+        int child_index = curr_node->letter_indexes[letter_index];
+        curr_node = curr_node->children[child_index];
+    }
+
+    curr_node->is_terminal_node = true;
+}
+
+/**
+ * Finds every node of a trie or word graph. A node shared by several
+ * branches of a word graph is only found once.
+ *
+ * @param   node    the root of the trie (or subtrie)
+ * @param   nodes   the nodes found so far, to which the nodes are added
+ */
+static void collect_trie_nodes (const TrieNode* node,
+                                unordered_set <const TrieNode*> &nodes)
+{
+    if (!nodes.insert(node).second)
+    {
+        return;
+    }
+
+    for (unsigned int i = 0; i < node->children.size(); i++)
+    {
+        collect_trie_nodes(node->children[i], nodes);
+    }
+}
+
+/**
+ * Frees a node and all of its descendants.
+ *
+ * @param   node    a TrieNode pointer of the root of the trie to delete
+ */
+void delete_word_trie (TrieNode* node)
+{
+    unordered_set <const TrieNode*> nodes;
+    collect_trie_nodes(node, nodes);
+
+    for (auto itr = nodes.begin(); itr != nodes.end(); itr++)
+    {
+        delete *itr;
+    }
+}
+
+/**
+ * Prints a word trie to the console. Uses recursive calls to go down the trie.
+ *
+ * @param   node    a TrieNode pointer of a node containing the data for a node
+ */
+void print_word_trie (TrieNode* node)
+{
+    // Output the node's letter property
+    cout << node->letter << endl;
+
+    // Go through all the node's children's letters
+    for (unsigned int i = 0; i < node->children.size(); i++)
+    {
+        cout << node->children[i]->letter << " ";
+    }
+
+    cout << endl << endl;
+
+    // Print each child of the node
+    for (unsigned int i = 0; i < node->children.size(); i++)
+    {
+        print_word_trie(node->children[i]);
+    }
+}
+
+/**
+ * @param   file_name   the name of the file containing the tiles
+ * @return  a vector of Tiles with each tile object containing the right data.
+ */
+vector <Tile> Engine::read_tile_data (string file_name)
+{
+    // Declare vector to store all the Tiles
+    vector <Tile> tiles;
+
+    // Open file containing the letter data
+    ifstream letter_data_file;
+    letter_data_file.open(file_name.c_str(), ifstream::in);
+
+    // Ensure data file is open
+    if (!letter_data_file.is_open())
+    {
+        load_errors += "Could not open " + file_name + "\n";
+        return tiles;
+    }
+
+    // Loop through all 27 possible tiles and add them to the vector
+    for (int i = 0; i < 27; i++)
+    {
+        Tile tile;
+        letter_data_file >> tile.letter >> tile.points >> tile.total;
+        tiles.push_back(tile);
+    }
+
+    return tiles;
+}
+
+/**
+ * @param   file_name   the name of the file containing the board layout
+ * @return  a SquareGrid containing the data for each square on the board.
+ *          Key for the text file's characters:
+ *              W = Triple Word Score
+ *              w = Double Word Score
+ *              L = Triple Letter Score
+ *              l = Double Letter Score
+ *              . = Regular Square
+ *              * = Square is out of bounds
+ */
+SquareGrid Engine::read_board_data (string file_name)
+{
+    // Declare board vector
+    SquareGrid board;
+
+    // Open file containing the board data
+    ifstream in_file;
+    in_file.open(file_name.c_str(), ifstream::in);
+
+    // Ensure file is open
+    if (!in_file.is_open())
+    {
+        load_errors += "Could not open " + file_name + "\n";
+        return board;
+    }
+
+    int row_num = 0;
+
+    // Get all the rows in the board
+    // The rows of x's around the actual board are to ensure that
+    // tiles are not added outside the board
+    while (in_file.good())
+    {
+        // Read a line from the text file
+        string line;
+        in_file >> line;
+
+        // Declare a row of Squares to store the data for each row
+        SquareRow row;
+
+        // Go through all the characters in each line
+        for (unsigned int i = 0; i < line.size(); i++)
+        {
+            Square sqr;
+            sqr.letter = '.';
+            sqr.row = row_num;
+            sqr.col = i;
+
+            // Assign the Square type to sqr
+            switch (line[i])
+            {
+                case 'W': sqr.type = triple_word;   break;
+                case 'w': sqr.type = double_word;   break;
+                case 'L': sqr.type = triple_letter; break;
+                case 'l': sqr.type = double_letter; break;
+                case '.': sqr.type = regular;       break;
+                case 'x': sqr.type = outside;       break;
+            }
+
+            // Assign the cross-check to sqr
+            switch (line[i])
+            {
+                case 'x':
+                    sqr.cross_check_mask = 0;
+                    sqr.letter = '.';
+                    break;
+                default:
+                    sqr.cross_check_mask = (1 << 26) - 1;
+                    break;
+            }
+
+            row.push_back(sqr);
+        }
+
+        board.push_back(row);
+        row_num++;
+    }
+
+    return board;
+}
+
+/**
+ * @param   stream  an output stream object to output to console
+ * @param   type    an object of class SquareType
+ * @return          an output stream object that is outputted
+ */
+ostream &operator << (ostream &stream, SquareType type)
+{
+    switch (type)
+    {
+        case triple_word:   stream << "triple_word";   break;
+        case double_word:   stream << "double_word";   break;
+        case triple_letter: stream << "triple_letter"; break;
+        case double_letter: stream << "double_letter"; break;
+        case regular:       stream << "regular";       break;
+        case outside:       stream << "outside";       break;
+    }
+
+    return stream;
+}
+
+/**
+ * Updates the cross_check_mask property of each square in the board
+ * Ex. board[row][col].cross_check_mask >> 3 & 1 indicates that the letter 'D'
+ *     (since 'D' - 'A' == 3) can be placed at board[row][col]
+ *
+ * @param   board   a SquareGrid containing the data for the state of the game
+ *                  This parameter is passed by reference since the board is
+ *                  being modified.
+ */
+void Engine::update_down_cross_checks (SquareGrid &board) const
+{
+    TraceSpan span ("cross_checks", "board");
+
+    for (int col = 1; col <= NUM_BOARD_COLS; col++)
+    {
+        update_col_down_cross_checks(board, col);
+    }
+}
+
+/**
+ * Updates the cross_check_mask property of each square in one column. Only
+ * the tiles in the column affect these cross-checks, so after a move only the
+ * columns with new or removed tiles need to be updated.
+ *
+ * @param   board   a SquareGrid containing the data for the state of the game
+ *                  This parameter is passed by reference since the board is
+ *                  being modified.
+ * @param   col     the column to update
+ */
+void Engine::update_col_down_cross_checks (SquareGrid &board, int col) const
+{
+    const SquareRow* rows [GRID_SIZE];
+
+    for (int row = 0; row < GRID_SIZE; row++)
+    {
+        rows[row] = &board[row];
+    }
+
+    // Go through all the squares in the column where tiles can be placed
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        // Only check squares on which tiles can be placed
+        if (board[row][col].letter != '.')
+        {
+            continue;
+        }
+
+        // The cross-check is set even when any letter can go on the square,
+        // since a tile that was above or below it may have been removed
+        board[row][col].cross_check_mask = find_col_cross_check(rows, row, col);
+    }
+}
+
+/**
+ * Finds the letters that can be placed on an empty square so that the word
+ * made down its column is in the lexicon.
+ *
+ * @param   rows    the rows of the board, including the outside rows
+ * @param   row     the row of the square
+ * @param   col     the column of the square
+ * @return          the cross-check of the square as a mask where bit 0 is 'A'
+ *                  and bit 25 is 'Z'
+ */
+uint32_t Engine::find_col_cross_check (const SquareRow* const* rows, int row,
+                                       int col) const
+{
+    string above_square, below_square;
+    int check_row = row - 1;
+
+    // Add characters above the cross-check square
+    while ((*rows[check_row])[col].letter != '.' &&
+           (*rows[check_row])[col].type   != outside)
+    {
+        above_square = (char) toupper((*rows[check_row])[col].letter)
+                       + above_square;
+        check_row--;
+    }
+
+    check_row = row + 1;
+
+    // Add characters below the cross-check square
+    while ((*rows[check_row])[col].letter != '.' &&
+           (*rows[check_row])[col].type   != outside)
+    {
+        below_square = below_square +
+                       (char) toupper((*rows[check_row])[col].letter);
+        check_row++;
+    }
+
+    // Any letter can go on a square with blank squares above and below
+    if (above_square == "" && below_square == "")
+    {
+        return (1 << 26) - 1;
+    }
+
+    // With a word (or a single letter) on only one side, the letters that
+    // can occupy the square are that word's hooks. A board that was edited
+    // by hand can have a fragment that is not a word, which has no hooks but
+    // can still be part of a longer word, so it is checked like a square
+    // between two fragments.
+    if (above_square == "" || below_square == "")
+    {
+        string fragment = above_square + below_square;
+        const WordHooks* fragment_hooks = NULL;
+
+        if (fragment.length() == 1)
+        {
+            fragment_hooks = &hooks[fragment[0] - 'A'];
+        }
+        else
+        {
+            uint32_t position = find_alphagram_word(alphagrams, fragment);
+
+            if (position != NO_ALPHAGRAM_WORD)
+            {
+                fragment_hooks = &hooks[26 + position];
+            }
+        }
+
+        if (fragment_hooks != NULL)
+        {
+            return (below_square == "") ? fragment_hooks->back :
+                                          fragment_hooks->front;
+        }
+    }
+
+    uint32_t valid_letters = 0;
+
+    // The word made has more than 2 letters, so it is in the word graph.
+    // Follow the letters above the square, then each letter that could
+    // occupy the square and the letters below it.
+    uint32_t node = lexicon.root();
+
+    for (size_t i = 0; i < above_square.length() &&
+                       node != NO_LEXICON_NODE; i++)
+    {
+        node = lexicon.child(node, above_square[i] - 'A');
+    }
+
+    uint32_t test_letters = (node != NO_LEXICON_NODE) ?
+                            lexicon.child_mask(node) : 0;
+
+    for (; test_letters != 0; test_letters &= test_letters - 1)
+    {
+        int test_letter_index = __builtin_ctz(test_letters);
+        uint32_t end = lexicon.child(node, test_letter_index);
+
+        for (size_t i = 0; i < below_square.length() &&
+                           end != NO_LEXICON_NODE; i++)
+        {
+            end = lexicon.child(end, below_square[i] - 'A');
+        }
+
+        // If the word is found, then make that letter valid
+        if (end != NO_LEXICON_NODE && lexicon.is_terminal(end))
+        {
+            valid_letters |= 1 << test_letter_index;
+        }
+    }
+
+    return valid_letters;
+}
+
+/**
+ * Updates the min_across_word_length property of every square on the board.
+ * This property stores the minimum length of the word going across starting from
+ * that square so that the word created connects with pre-existing words.
+ * Ex. If board[row][col].min_across_word_length == 4 indicates that a word must
+ *     be 4 letters long before it connects with pre-existing words.
+ *     Otherwise, the word will be disconnected.
+ *
+ *
+ * @param   board   a SquareGrid containing the data for the state of the game
+ *                  This parameter is passed by reference since the board is
+ *                  being modified.
+ */
+void Engine::update_min_across_word_length (SquareGrid &board) const
+{
+    // Go through all the rows
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        update_row_min_across_word_length(board, row);
+    }
+}
+
+/**
+ * Finds the min_across_word_length of each square in one row from the tiles
+ * in the row and in the rows above and below it.
+ *
+ * @param   above   the squares of the row above
+ * @param   squares the squares of the row
+ * @param   below   the squares of the row below
+ * @param   lengths set to the minimum word length of each column from 1 to
+ *                  NUM_BOARD_COLS
+ */
+static void find_row_min_lengths (const SquareRow &above,
+                                  const SquareRow &squares,
+                                  const SquareRow &below, int* lengths)
+{
+    // Set the minimum word length as -1 to signify
+    // squares rightward of any adjacent square
+    // These squares cannot be used as the leftmost square from which
+    // to extend rightwards
+    int min_word_length = -1;
+
+    // Go through all the squares in the row from right to left
+    for (int col = NUM_BOARD_COLS; col >= 1; col--)
+    {
+        // If the square to its immediate left is occupied with a letter,
+        // then the square at squares[col] cannot be the left-most square
+        // Thus, min_across_word_length == -1
+        if (squares[col-1].letter != '.')
+        {
+            lengths[col] = -1;
+        }
+        // Check to see if there are tiles above, below,
+        // right, or on the square
+        // If so, then set the min_across_word_length to 1
+        else if (above[col].letter     != '.' ||
+                 below[col].letter     != '.' ||
+                 squares[col+1].letter != '.' ||
+                 squares[col].letter   != '.' )
+        {
+            lengths[col] = 1;
+            min_word_length = 1;
+        }
+        // For squares on the extreme right which cannot be used to
+        // build a word since there are no squares to the right from
+        // which tiles can be added.
+        // Ie. Extending right from this square will always create a word
+        // that is separated from the rest of the words already on the board.
+        else if (min_word_length == -1)
+        {
+            lengths[col] = -1;
+        }
+        // These squares are not adjacent to any square, but extending right
+        // will eventually reach a square
+        else
+        {
+            min_word_length++;
+            lengths[col] = min_word_length;
+        }
+    }
+}
+
+/**
+ * Updates the min_across_word_length property of each square in one row. Only
+ * the tiles in the row and in the rows above and below it affect these
+ * lengths.
+ *
+ * @param   board   a SquareGrid containing the data for the state of the game
+ *                  This parameter is passed by reference since the board is
+ *                  being modified.
+ * @param   row     the row to update
+ */
+void Engine::update_row_min_across_word_length (SquareGrid &board,
+                                                int row) const
+{
+    int lengths [GRID_SIZE];
+    find_row_min_lengths(board[row-1], board[row], board[row+1], lengths);
+
+    for (int col = 1; col <= NUM_BOARD_COLS; col++)
+    {
+        board[row][col].min_across_word_length = lengths[col];
+    }
+}
+
+/**
+ * Returns a vector of integers which represents the letters on a Scrabble rack.
+ * These letters are available to be placed on the board.
+ *
+ * @param   letters     a string of all the letters in the rack
+ * @return              a vector of 26 integers where each element represents
+ *                      the number of tiles of that letter.
+ *                      Ex. rack[4] == 2 indicates 2 E's are in the rack
+ */
+vector <int> fill_rack (string letters)
+{
+    vector <int> rack;
+    fill_rack(letters, rack);
+    return rack;
+}
+
+/**
+ * Fills in a vector of integers which represents the letters on a Scrabble
+ * rack, reusing its memory.
+ *
+ * @param   letters     a string of all the letters in the rack
+ * @param   rack        set to 27 integers where each element represents the
+ *                      number of tiles of that letter ([26] = blanks)
+ */
+void fill_rack (const string &letters, vector <int> &rack)
+{
+    rack.assign(27, 0);
+
+    // Set the number of characters to read as
+    // the min of NUM_RACK_TILES and the length of the string "letters"
+    int num_chars_read = (NUM_RACK_TILES > letters.length()) ?
+                         (letters.length()) : (NUM_RACK_TILES);
+
+    // Go through all the necessary characters to read
+    for (int i = 0; i < num_chars_read; i++)
+    {
+        // For regular tiles
+        if (isupper((unsigned char) letters[i]))
+        {
+            rack[letters[i] - 'A']++;
+        }
+        // For blank tiles
+        else if (letters[i] == '*')
+        {
+            rack[26]++;
+        }
+    }
+}
+
+/**
+ * @param   rack    the number of each tile in the rack ([26] = blanks)
+ * @return          the tiles in the rack as a mask where bit 0 is 'A', bit 25
+ *                  is 'Z' and bit 26 is a blank
+ */
+static uint32_t get_rack_mask (const vector <int> &rack)
+{
+    uint32_t rack_mask = 0;
+
+    for (int i = 0; i < 27; i++)
+    {
+        rack_mask |= (rack[i] > 0) ? (1 << i) : 0;
+    }
+
+    return rack_mask;
+}
+
+/**
+ * Find the highest scoring possible move and the points obtained based on
+ * board and rack.
+ *
+ * @param   board   stores the state of the Scrabble board
+ * @param   rack    stores the number of each possible tile
+ * @param   best_move   stores the highest scoring move and its points and is
+ *                      passed by reference
+ * @param   context     the mutable state of the search, which must not be
+ *                      used by another thread at the same time
+ */
+void Engine::find_best_move (const SquareGrid &board, const vector <int> &rack,
+                             Move &best_move, SearchContext &context) const
+{
+    TraceSpan span ("find_best_move", "search");
+
+    // Go through all the squares to check for any squares that have tiles
+    // This loop will find the best move for a board with tiles on it
+    // and exit the function as soon as it finds a tile
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            // Check to see if the square has a tile
+            // Only find the best move for a board with tiles
+			// if a square on the board has a tile
+            if (board[row][col].letter != '.')
+            {
+                // Get the best move for placing tiles across and
+                // for placing tiles down
+                Move best_across_move =
+                                find_best_across_move(board, rack, context);
+                Move best_down_move =
+                                find_best_down_move(board, rack, context);
+
+                // Select either the best across move or the down move
+                if (best_across_move.score > best_down_move.score)
+                {
+                    best_move = best_across_move;
+                }
+                else
+                {
+                    best_move = best_down_move;
+                }
+
+                // Only find the best move for a board with tiles once
+				// and exit the function
+                return;
+            }
+        }
+    }
+
+    //
+    // If the function has reached this line, the board is empty
+    // This means the program needs to find the best starting move
+    // Scrabble rules dictate that the first move must contain 2 or more tiles
+    //
+
+    // Find the middle row and column since these determine the
+    int mid_row = NUM_BOARD_ROWS/2 + 1;
+    int mid_col = NUM_BOARD_COLS/2 + 1;
+
+    // The minimum word lengths of the middle row are changed on a copy of the
+    // board, and the tiles are taken from and put back into a copy of the
+    // rack. The copies are kept in the pool if there is one.
+    SquareGrid local_board;
+    vector <int> local_rack;
+    SquareGrid &first_board = (context.pool != NULL) ?
+                              context.pool->boards[ACROSS] : local_board;
+    vector <int> &search_rack = (context.pool != NULL) ?
+                                context.pool->rack : local_rack;
+    first_board = board;
+    search_rack = rack;
+
+    // The premiums do not depend on the minimum word lengths set below
+    ScoreTable table;
+    build_score_table(first_board, table);
+
+    // Go through all the squares left of and including the center square
+    for (int col = 1; col <= mid_col; col++)
+    {
+        // Set the minimum length of the first word to be placed so that
+        // it covers the center square
+        first_board[mid_row][col].min_across_word_length = mid_col - col + 1;
+
+        // There is an exception for the center square if it is the
+        // leftmost square of the starting move
+        // One must place at least 2 tiles to start the game, so its
+        // min_across_word_length is 2
+        if (col == mid_col)
+        {
+            first_board[mid_row][mid_col].min_across_word_length = 2;
+        }
+
+        int min_word_length = first_board[mid_row][col].min_across_word_length;
+
+        // Only call extend_right when necessary
+        // Ie. When less than 7 characters are needed to connect to
+        // pre-existing words AND it is possible to connect to pre-existing
+        // words to the right of the square
+        if (min_word_length <= NUM_RACK_TILES && min_word_length != -1)
+        {
+            TraceSpan anchor_span ("anchor", "search", mid_row, col);
+            extend_right(first_board[mid_row], table.lines[ACROSS][mid_row],
+                         search_rack, mid_row, col, min_word_length,
+                         best_move, context);
+        }
+    }
+
+    find_best_two_letter_move(first_board[mid_row], rack,
+                              table.lines[ACROSS][mid_row], mid_row, true,
+                              best_move);
+}
+
+/**
+ * Find the highest scoring possible move using a new SearchContext.
+ *
+ * @param   board       stores the state of the Scrabble board
+ * @param   rack        stores the number of each possible tile
+ * @param   best_move   stores the highest scoring move and its points and is
+ *                      passed by reference
+ */
+void Engine::find_best_move (const SquareGrid &board, const vector <int> &rack,
+                             Move &best_move) const
+{
+    SearchContext context = {};
+    find_best_move(board, rack, best_move, context);
+}
+
+/**
+ * Updates the lines of a board that a change of letters affects, and marks
+ * the lines that must be searched again. The board's letters must already
+ * have been changed.
+ *
+ * @param   engine          the engine whose lexicon gives the cross-checks
+ * @param   board           the board to update
+ * @param   changed_rows    true for each row with a letter that changed,
+ *                          including the outside rows 0 and NUM_BOARD_ROWS + 1
+ * @param   changed_cols    true for each column with a letter that changed
+ * @param   search_rows     set to true for each row that must be searched
+ * @param   undo_squares    if not NULL, the state of each square is added to
+ *                          the end before its cross-check or minimum word
+ *                          length is changed
+ */
+static void update_changed_lines (const Engine &engine, SquareGrid &board,
+                                  const bool* changed_rows,
+                                  const bool* changed_cols, bool* search_rows,
+                                  vector <UndoSquare>* undo_squares)
+{
+    // A row with a new or removed tile is always searched again
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        search_rows[row] = search_rows[row] || changed_rows[row];
+    }
+
+    // The cross-checks of a column only depend on its own tiles
+    for (int col = 1; col <= NUM_BOARD_COLS; col++)
+    {
+        if (!changed_cols[col])
+        {
+            continue;
+        }
+
+        uint32_t old_masks [NUM_BOARD_ROWS + 1];
+
+        for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+        {
+            old_masks[row] = board[row][col].cross_check_mask;
+        }
+
+        engine.update_col_down_cross_checks(board, col);
+
+        for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+        {
+            const Square &sqr = board[row][col];
+
+            if (sqr.cross_check_mask == old_masks[row])
+            {
+                continue;
+            }
+
+            if (undo_squares != NULL)
+            {
+                undo_squares->push_back({(uint8_t) row, (uint8_t) col,
+                                         sqr.letter,
+                                         (int8_t) sqr.min_across_word_length,
+                                         old_masks[row]});
+            }
+
+            if (sqr.letter == '.')
+            {
+                search_rows[row] = true;
+            }
+        }
+    }
+
+    // The minimum word lengths of a row depend on its own tiles and on the
+    // tiles of the rows above and below it
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        if (!changed_rows[row - 1] && !changed_rows[row] &&
+            !changed_rows[row + 1])
+        {
+            continue;
+        }
+
+        int old_lengths [NUM_BOARD_COLS + 1];
+
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            old_lengths[col] = board[row][col].min_across_word_length;
+        }
+
+        engine.update_row_min_across_word_length(board, row);
+
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            const Square &sqr = board[row][col];
+
+            if (sqr.min_across_word_length == old_lengths[col])
+            {
+                continue;
+            }
+
+            if (undo_squares != NULL)
+            {
+                undo_squares->push_back({(uint8_t) row, (uint8_t) col,
+                                         sqr.letter, (int8_t) old_lengths[col],
+                                         sqr.cross_check_mask});
+            }
+
+            search_rows[row] = true;
+        }
+    }
+}
+
+/**
+ * Finds the best move of a board and rack using the best moves of each row and
+ * column found by the previous call with the same MoveList. Only the rows and
+ * columns affected by the tiles added or removed since then are searched
+ * again, or every line if the rack changed. The best move and its points are
+ * left in the MoveList.
+ *
+ * @param   board       the state of the Scrabble board. Only its letters are
+ *                      used, so update_board need not have been called.
+ * @param   rack        stores the number of each possible tile
+ * @param   moves       the best moves of the previous search, which are
+ *                      updated for this board and rack
+ * @param   context     the mutable state of the search
+ */
+void Engine::update_move_list (const SquareGrid &board,
+                               const vector <int> &rack, MoveList &moves,
+                               SearchContext &context) const
+{
+    TraceSpan span ("update_move_list", "search");
+
+    // The first move is found by find_best_move and starts a new list
+    if (count_board_tiles(board) == 0)
+    {
+        moves.is_valid = false;
+        moves.best_move = Move();
+        find_best_move(board, rack, moves.best_move, context);
+        return;
+    }
+
+    bool search_lines [2][NUM_BOARD_ROWS + 2] = {{false}};
+    bool changed_lines [2][NUM_BOARD_ROWS + 2] = {{false}};
+    bool is_new_list = !moves.is_valid;
+
+    if (is_new_list)
+    {
+        moves.boards[ACROSS] = layout;
+
+        for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+        {
+            for (int col = 1; col <= NUM_BOARD_COLS; col++)
+            {
+                moves.boards[ACROSS][row][col].letter = board[row][col].letter;
+            }
+        }
+
+        update_board(moves.boards[ACROSS]);
+        invert_board(moves.boards[ACROSS], moves.boards[DOWN]);
+        moves.is_valid = true;
+    }
+    else
+    {
+        // Copy the letters that changed to both boards
+        for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+        {
+            for (int col = 1; col <= NUM_BOARD_COLS; col++)
+            {
+                char letter = board[row][col].letter;
+
+                if (moves.boards[ACROSS][row][col].letter != letter)
+                {
+                    moves.boards[ACROSS][row][col].letter = letter;
+                    moves.boards[DOWN][col][row].letter = letter;
+                    changed_lines[ACROSS][row] = true;
+                    changed_lines[DOWN][col] = true;
+                }
+            }
+        }
+
+        // The rows of the inverted board are the columns of the board
+        update_changed_lines(*this, moves.boards[ACROSS], changed_lines[ACROSS],
+                             changed_lines[DOWN], search_lines[ACROSS], NULL);
+        update_changed_lines(*this, moves.boards[DOWN], changed_lines[DOWN],
+                             changed_lines[ACROSS], search_lines[DOWN], NULL);
+    }
+
+    // A change of letters also changes the cross points of the squares
+    // next to it in the other direction
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        ScoreTable table;
+        build_score_table(moves.boards[dir], table);
+
+        for (int line = 1; line <= NUM_BOARD_ROWS; line++)
+        {
+            const ScoreLine &new_line = table.lines[ACROSS][line];
+            const ScoreLine &old_line = moves.tables[dir].lines[ACROSS][line];
+
+            if (is_new_list ||
+                memcmp(new_line.cross_pts, old_line.cross_pts,
+                       sizeof(new_line.cross_pts)) != 0 ||
+                memcmp(new_line.has_cross, old_line.has_cross,
+                       sizeof(new_line.has_cross)) != 0)
+            {
+                search_lines[dir][line] = true;
+            }
+        }
+
+        moves.tables[dir] = table;
+    }
+
+    bool is_new_rack = (moves.rack != rack);
+    moves.rack = rack;
+
+    // Search the lines again and find the best move of each direction. Ties
+    // are broken as find_best_move breaks them.
+    int best_line [2] = {0, 0};
+    int best_line_pts [2] = {0, 0};
+
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        TraceSpan dir_span ((dir == ACROSS) ? "across" : "down", "search");
+
+        for (int line = 1; line <= NUM_BOARD_ROWS; line++)
+        {
+            if (is_new_list || is_new_rack || search_lines[dir][line])
+            {
+                moves.line_moves[dir][line] = Move();
+                find_best_row_move(moves.boards[dir][line], rack,
+                                   moves.tables[dir].lines[ACROSS][line], line,
+                                   moves.line_moves[dir][line], context);
+                moves.lines_searched++;
+            }
+            else
+            {
+                moves.lines_kept++;
+            }
+
+            if (moves.line_moves[dir][line].score > best_line_pts[dir])
+            {
+                best_line[dir] = line;
+                best_line_pts[dir] = moves.line_moves[dir][line].score;
+            }
+        }
+    }
+
+    if (best_line_pts[ACROSS] > best_line_pts[DOWN])
+    {
+        moves.best_move = moves.line_moves[ACROSS][best_line[ACROSS]];
+    }
+    else if (best_line[DOWN] != 0)
+    {
+        moves.best_move = invert_move(moves.line_moves[DOWN][best_line[DOWN]]);
+    }
+    else
+    {
+        moves.best_move = Move();
+    }
+}
+
+/**
+ * Finds the best move of a BoardOverlay. Each line is searched on the lines
+ * and ScoreTables of the overlay, so the lines that no move of the overlay
+ * changed are read from its snapshot.
+ *
+ * @param   overlay     the position, which reset_overlay has been called on
+ * @param   rack        stores the number of each possible tile
+ * @param   best_move   set to the highest scoring move and its points
+ * @param   context     the mutable state of the search
+ */
+void Engine::find_best_overlay_move (const BoardOverlay &overlay,
+                                     const vector <int> &rack,
+                                     Move &best_move,
+                                     SearchContext &context) const
+{
+    TraceSpan span ("find_best_overlay_move", "search");
+
+    // The first move is found on the empty board of the snapshot
+    if (overlay.num_tiles == 0)
+    {
+        find_best_move(overlay.snapshot->boards[ACROSS], rack, best_move,
+                       context);
+        return;
+    }
+
+    Move dir_moves [2] = {};
+
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        TraceSpan dir_span ((dir == ACROSS) ? "across" : "down", "search");
+
+        for (int line = 1; line <= NUM_BOARD_ROWS; line++)
+        {
+            find_best_row_move(*overlay.lines[dir][line], rack,
+                               *overlay.score_lines[dir][line], line,
+                               dir_moves[dir], context);
+        }
+    }
+
+    // Ties are broken as find_best_move breaks them
+    if (dir_moves[ACROSS].score > dir_moves[DOWN].score)
+    {
+        best_move = dir_moves[ACROSS];
+    }
+    else
+    {
+        best_move = invert_move(dir_moves[DOWN]);
+    }
+}
+
+/**
+ * Returns the move that scores the most possible points by placing tiles
+ * horizontally for a given Scrabble board and a rack.
+ *
+ * @param   board       stores the state of the Scrabble board
+ * @param   rack        stores the number of each possible tile
+ * @param   context     the mutable state of the search
+ * @return              the highest scoring move involving tiles placed
+ *                      horizontally, along with its points
+ */
+Move Engine::find_best_across_move (const SquareGrid &board,
+                                    const vector <int> &rack,
+                                    SearchContext &context) const
+{
+    TraceSpan span ("across", "search");
+
+    // Store the best move and its points
+    Move best_move = {};
+
+    ScoreTable table;
+    build_score_table(board, table);
+
+    // Go through all the rows in the board
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        Move row_move = {};
+        find_best_row_move(board[row], rack, table.lines[ACROSS][row], row,
+                           row_move, context);
+
+        if (row_move.score > best_move.score)
+        {
+            best_move = row_move;
+        }
+    }
+
+    return best_move;
+}
+
+/**
+ * Makes the key of a row in a MoveCache from everything that the search of
+ * the row depends on.
+ *
+ * @param   squares     the squares of the row, on which update_board has
+ *                      been called
+ * @param   score_line  the ScoreLine of the row
+ * @param   rack        stores the number of each possible tile
+ * @param   key         set to the key of the row
+ */
+static void make_row_key (const SquareRow &squares,
+                          const ScoreLine &score_line,
+                          const vector <int> &rack, string &key)
+{
+    key.clear();
+
+    for (int col = 1; col <= NUM_BOARD_COLS; col++)
+    {
+        const Square &sqr = squares[col];
+        uint32_t cross_check = sqr.cross_check_mask;
+
+        key += sqr.letter;
+        key += (char) sqr.min_across_word_length;
+        key += (char) sqr.type;
+        key += (char) score_line.has_cross[col];
+        key.append((const char*) &score_line.cross_pts[col],
+                   sizeof(int16_t));
+        key.append((const char*) &cross_check, sizeof(cross_check));
+    }
+
+    for (int i = 0; i < 27; i++)
+    {
+        key += (char) rack[i];
+    }
+}
+
+/**
+ * Finds the highest scoring across move in one row, or looks it up in the
+ * MoveCache of the context if the row has been searched before.
+ *
+ * @param   squares     the squares of the row, on which update_board has
+ *                      been called
+ * @param   rack        stores the number of each possible tile
+ * @param   score_line  the ScoreLine of the row
+ * @param   row         the row to search
+ * @param   best_move   replaced by a higher scoring move, if one is found
+ * @param   context     the mutable state of the search
+ */
+void Engine::find_best_row_move (const SquareRow &squares,
+                                 const vector <int> &rack,
+                                 const ScoreLine &score_line, int row,
+                                 Move &best_move, SearchContext &context) const
+{
+    TraceSpan row_span ("row", "search", row);
+    MoveCache* cache = context.move_cache;
+    string local_key;
+    string &key = (context.pool != NULL) ? context.pool->row_key : local_key;
+
+    if (cache != NULL)
+    {
+        make_row_key(squares, score_line, rack, key);
+        auto itr = cache->rows.find(key);
+
+        if (itr != cache->rows.end())
+        {
+            cache->hits++;
+
+            if (itr->second.score > best_move.score)
+            {
+                best_move = itr->second;
+                best_move.row = row;
+            }
+
+            return;
+        }
+    }
+
+    // The tiles are taken from and put back into a copy of the rack
+    Move row_move = {};
+    vector <int> local_rack;
+    vector <int> &search_rack = (context.pool != NULL) ?
+                                context.pool->rack : local_rack;
+    search_rack = rack;
+
+    for (int col = 1; col <= NUM_BOARD_COLS; col++)
+    {
+        int min_word_length = squares[col].min_across_word_length;
+
+        // Only call extend_right when necessary
+        // Ie. When less than 7 characters are needed to connect to
+        // pre-existing words AND it is possible to connect to pre-existing
+        // words to the right of the square
+        if (min_word_length <= NUM_RACK_TILES && min_word_length != -1)
+        {
+            TraceSpan anchor_span ("anchor", "search", row, col);
+            extend_right(squares, score_line, search_rack, row, col,
+                         min_word_length, row_move, context);
+        }
+    }
+
+    // The trie only has words longer than 2 letters, so two-letter words
+    // are found separately
+    find_best_two_letter_move(squares, rack, score_line, row, false,
+                              row_move);
+
+    if (cache != NULL)
+    {
+        if (cache->rows.size() >= cache->max_rows)
+        {
+            cache->rows.clear();
+        }
+
+        cache->rows[key] = row_move;
+        cache->misses++;
+    }
+
+    if (row_move.score > best_move.score)
+    {
+        best_move = row_move;
+    }
+}
+
+/**
+ * Finds the highest scoring across move in a row whose across word has 2
+ * letters.
+ * There are many of these moves on a crowded board, so rather than walking
+ * the trie, the letters that can go on each pair of squares are found from
+ * the cross-checks and the back hooks of each letter (which are the
+ * two-letter words starting with it), and each move is scored with the
+ * row's ScoreLine.
+ *
+ * @param   squares         the squares of the row, on which update_board has
+ *                          been called
+ * @param   rack            stores the number of each possible tile
+ * @param   score_line      the ScoreLine of the row
+ * @param   row             the row in which to place the tiles
+ * @param   is_first_move   true if the board is empty, in which case the
+ *                          move must cover the centre square
+ * @param   best_move       replaced by a higher scoring move, if one is found
+ */
+void Engine::find_best_two_letter_move (const SquareRow &squares,
+                                        const vector <int> &rack,
+                                        const ScoreLine &score_line, int row,
+                                        bool is_first_move,
+                                        Move &best_move) const
+{
+    int mid_row = NUM_BOARD_ROWS/2 + 1;
+    int mid_col = NUM_BOARD_COLS/2 + 1;
+
+    // The letters that can be placed from the rack
+    uint32_t rack_letters = (rack[26] > 0) ? (1 << 26) - 1 :
+                            get_rack_mask(rack);
+
+    for (int col = 1; col < NUM_BOARD_COLS; col++)
+    {
+        const Square &first = squares[col];
+        const Square &second = squares[col+1];
+
+        // The squares right before and after the word must be empty
+        if (score_line.occupied[col - 1] || score_line.occupied[col + 2] ||
+            (first.letter != '.' && second.letter != '.'))
+        {
+            continue;
+        }
+
+        // Without a tile in the pair, a tile must be placed next to a
+        // tile above or below (or on the centre square on the first move)
+        if (first.letter == '.' && second.letter == '.' &&
+            (is_first_move ?
+             (row != mid_row || col < mid_col - 1 || col > mid_col) :
+             (!score_line.has_cross[col] && !score_line.has_cross[col + 1])))
+        {
+            continue;
+        }
+
+        // Go through every first letter and then every second letter
+        // that makes a two-letter word with it
+        for (int first_index = 0; first_index < 26; first_index++)
+        {
+            char first_letter = 'A' + first_index;
+            int first_tile = -1;    // The rack index of the tile placed
+            Play play = {row, col, ACROSS, 2, ".."};
+
+            if (first.letter != '.')
+            {
+                if (toupper(first.letter) != first_letter)
+                {
+                    continue;
+                }
+            }
+            else if ((rack_letters >> first_index & 1) &&
+                     (first.cross_check_mask >> first_index & 1))
+            {
+                first_tile = (rack[first_index] > 0) ? first_index : 26;
+                play.tiles[0] = (first_tile == 26) ?
+                                tolower(first_letter) : first_letter;
+            }
+            else
+            {
+                continue;
+            }
+
+            uint32_t second_letters = hooks[first_index].back;
+
+            for (int second_index = 0; second_index < 26; second_index++)
+            {
+                if (!(second_letters >> second_index & 1))
+                {
+                    continue;
+                }
+
+                char second_letter = 'A' + second_index;
+                int num_letters = rack[second_index]
+                                - (first_tile == second_index);
+                int num_blanks = rack[26] - (first_tile == 26);
+
+                if (second.letter != '.')
+                {
+                    if (toupper(second.letter) != second_letter)
+                    {
+                        continue;
+                    }
+                }
+                else if ((num_letters > 0 || num_blanks > 0) &&
+                         (second.cross_check_mask >> second_index & 1))
+                {
+                    play.tiles[1] = (num_letters > 0) ?
+                                    second_letter : tolower(second_letter);
+                }
+                else
+                {
+                    continue;
+                }
+
+                int curr_pts = score_line_play(score_line, col, play);
+
+                if (curr_pts > best_move.score)
+                {
+                    best_move = Move();
+                    best_move.score = curr_pts;
+
+                    for (int i = 0; i < 2; i++)
+                    {
+                        if (play.tiles[i] != '.')
+                        {
+                            add_sqr_to_move(row, col + i, play.tiles[i],
+                                            best_move);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Returns the move that scores the most possible points by placing tiles
+ * vertically for a given Scrabble board and a rack.
+ *
+ * @param   board       stores the state of the Scrabble board
+ * @param   rack        stores the number of each possible tile
+ * @param   context     the mutable state of the search
+ * @return              the highest scoring move involving tiles placed
+ *                      vertically, along with its points
+ */
+Move Engine::find_best_down_move (const SquareGrid &board,
+                                  const vector <int> &rack,
+                                  SearchContext &context) const
+{
+    TraceSpan span ("down", "search");
+    SquareGrid local_board;
+    SquareGrid &inverted_board = (context.pool != NULL) ?
+                                 context.pool->boards[DOWN] : local_board;
+    invert_board(board, inverted_board);
+
+    // Find the best down move by calling the find_best_across_move() function
+    // on the inverted board
+    Move best_down_move = find_best_across_move(inverted_board, rack, context);
+    return invert_move(best_down_move);
+}
+
+/**
+ * Finds the best move by extending rightwards from a given square. The squares
+ * of the word are visited one after another with an ExtendFrame for each, so
+ * a word of up to NUM_BOARD_COLS squares needs no recursion. The children of a
+ * node are tried in alphabetical order, and each square adds its points to a
+ * running score taken from the row's ScoreLine.
+ *
+ * @param   row_squares         the squares of the row of the word
+ * @param   score_line          the ScoreLine of the row
+ * @param   rack                a vector of integers storing the number of each
+ *                              type of tile. The tiles placed are taken from
+ *                              it and put back before returning.
+ * @param   row                 the row of the first square of the word
+ * @param   col                 the column of the first square of the word
+ * @param   min_word_length     the minimum word length of the word to be created
+ *                              so that it connects with pre-existing words
+ * @param   best_move           the best possible move thus far and its points
+ * @param   context             the mutable state of the search
+ */
+void Engine::extend_right (const SquareRow &row_squares,
+                           const ScoreLine &score_line, vector <int> &rack,
+                           int row, int col, int min_word_length,
+                           Move &best_move, SearchContext &context) const
+{
+    const Square* squares = &row_squares[col];
+    const int8_t* letter_mult = score_line.letter_mult + col;
+    const int8_t* word_mult = score_line.word_mult + col;
+    const int8_t* has_cross = score_line.has_cross + col;
+    const int16_t* tile_pts = score_line.tile_pts + col;
+    const int16_t* cross_pts = score_line.cross_pts + col;
+
+    // The letter on each square of the word so far ('.' if it already had a
+    // tile)
+    char letters [NUM_BOARD_COLS + 1];
+
+    ExtendFrame stack [NUM_BOARD_COLS + 1];
+    ExtendFrame* frame = stack;
+    frame->node = lexicon.root();
+    frame->rack_mask = get_rack_mask(rack);
+    frame->tile = -1;
+    frame->main_pts = score_line.before_pts[col];
+    frame->main_mult = 1;
+    frame->cross_pts = 0;
+    frame->num_tiles = 0;
+    bool entered = true;
+
+    while (frame >= stack)
+    {
+        int depth = frame - stack;
+        const Square &sqr = squares[depth];
+
+        if (entered)
+        {
+            entered = false;
+            frame->letters = 0;
+
+            // There are no more squares in the row
+            if (sqr.type == outside)
+            {
+                frame--;
+                continue;
+            }
+            // The square contains a letter, so the word can only continue
+            // with the node's child of that letter
+            else if (sqr.letter != '.')
+            {
+                int sqr_letter_index = toupper(sqr.letter) - 'A';
+                uint32_t child = lexicon.child(frame->node, sqr_letter_index);
+
+                if (child == NO_LEXICON_NODE)
+                {
+                    frame--;
+                    continue;
+                }
+
+                ExtendFrame* next = frame + 1;
+                *next = *frame;
+                next->node = child;
+                next->tile = -1;
+                next->main_pts += tile_pts[depth];
+                letters[depth] = '.';
+
+                context.trie_edges_visited++;
+                frame = next;
+                entered = true;
+                continue;
+            }
+
+            // Determine if a legal move has been found ie. a word is created
+            // and the word is long enough so that it can connect with
+            // pre-existing tiles
+            if (lexicon.is_terminal(frame->node) &&
+                frame->num_tiles >= min_word_length)
+            {
+                int bingo_pts = (frame->num_tiles >= NUM_RACK_TILES) ? 50 : 0;
+                int score = frame->main_pts * frame->main_mult +
+                            frame->cross_pts + bingo_pts;
+
+                if (score > best_move.score)
+                {
+                    // The move starts at its first tile and ends at its last
+                    int first = 0;
+                    int last = depth - 1;
+
+                    while (letters[first] == '.')
+                    {
+                        first++;
+                    }
+
+                    while (letters[last] == '.')
+                    {
+                        last--;
+                    }
+
+                    best_move = Move();
+                    best_move.score = score;
+                    best_move.row = row;
+                    best_move.col = col + first;
+                    best_move.direction = ACROSS;
+                    best_move.length = last - first + 1;
+                    best_move.num_tiles = frame->num_tiles;
+                    memcpy(best_move.tiles, letters + first, best_move.length);
+                }
+            }
+
+            // The children whose letter is in the square's down cross-check
+            // and can be placed from the rack (any letter if there is a blank)
+            const FlatNode &flat_node = lexicon.nodes[frame->node];
+            uint32_t child_letters = flat_node.child_mask & ~FLAT_TERMINAL_BIT;
+            uint32_t rack_letters = (frame->rack_mask & (1 << 26)) ?
+                                    (1 << 26) - 1 : frame->rack_mask;
+            frame->letters = child_letters & sqr.cross_check_mask &
+                             rack_letters;
+        }
+
+        // Place the tile of the last child tried back in the rack
+        if (frame->tile != -1)
+        {
+            rack[frame->tile]++;
+            frame->tile = -1;
+        }
+
+        if (frame->letters == 0)
+        {
+            frame--;
+            continue;
+        }
+
+        // Go through the children in alphabetical order. They are stored
+        // together from the node's first child, so the index of a child is
+        // the number of children with an earlier letter.
+        const FlatNode &flat_node = lexicon.nodes[frame->node];
+        uint32_t child_letters = flat_node.child_mask & ~FLAT_TERMINAL_BIT;
+        int child_letter_index = __builtin_ctz(frame->letters);
+        frame->letters &= frame->letters - 1;
+        uint32_t earlier_letters =
+                    child_letters & ((1u << child_letter_index) - 1);
+        uint32_t child_index = flat_node.first_child +
+                               __builtin_popcount(earlier_letters);
+
+        // Use the letter's tile if it is in the rack, and a blank tile
+        // otherwise
+        int tile = (rack[child_letter_index] > 0) ? child_letter_index : 26;
+        char letter = (tile == 26) ? 'a' + child_letter_index :
+                                     'A' + child_letter_index;
+
+        // Remove the tile from the rack
+        rack[tile]--;
+        frame->tile = tile;
+
+        ExtendFrame* next = frame + 1;
+        next->node = lexicon.children[child_index];
+        next->rack_mask = (rack[tile] > 0) ? frame->rack_mask :
+                          frame->rack_mask & ~(1 << tile);
+        next->tile = -1;
+
+        int placed_pts = letter_pts[(int) letter] * letter_mult[depth];
+        next->main_pts = frame->main_pts + placed_pts;
+        next->main_mult = frame->main_mult * word_mult[depth];
+        next->cross_pts = frame->cross_pts + has_cross[depth] *
+                          word_mult[depth] * (cross_pts[depth] + placed_pts);
+        next->num_tiles = frame->num_tiles + 1;
+        letters[depth] = letter;
+
+        context.trie_edges_visited++;
+        frame = next;
+        entered = true;
+    }
+}
+
+/**
+ * Adds the square, on which a tile has just been placed, onto the current move.
+ * The square must be after the last square of the move in its direction, and
+ * the squares in between are marked as already having a tile.
+ *
+ * @param   row         the row of the square to be added
+ * @param   col         the column of the square to be added
+ * @param   letter      the letter of the square to be added
+ * @param   curr_move   the current move. This move is passed by reference
+ *                      since it is directly modified.
+ */
+void add_sqr_to_move (int row, int col, char letter, Move &curr_move)
+{
+    if (curr_move.num_tiles == 0)
+    {
+        curr_move.row = row;
+        curr_move.col = col;
+        curr_move.length = 0;
+    }
+
+    int index = (curr_move.direction == DOWN) ? row - curr_move.row :
+                                                col - curr_move.col;
+
+    while (curr_move.length < index)
+    {
+        curr_move.tiles[curr_move.length++] = '.';
+    }
+
+    curr_move.tiles[curr_move.length++] = letter;
+    curr_move.tiles[curr_move.length] = '\0';
+    curr_move.num_tiles++;
+}
+
+/**
+ * Calculates the number of points obtained for a given across move.
+ *
+ * @param   board           a pointer to the SquareGrid containing all the data
+ *                          for a Scrabble Board
+ * @param   across_move     the tiles placed for a given across move
+ * @return                  the number of points obtained from an across move
+ */
+int Engine::calc_across_pts (const SquareGrid* board,
+                             const Move &across_move) const
+{
+    // If no squares are in the current move, then no points are awards
+    if (across_move.num_tiles == 0)
+    {
+        return 0;
+    }
+
+    // Set the variables that will increment at 0
+    int row_pts = 0;
+    int total_cross_pts = 0;
+    int num_double_word = 0;
+    int num_triple_word = 0;
+
+    // Go through all the squares in the current move
+    for (int i = 0; i < across_move.length; i++)
+    {
+        // Skip the squares that already have a tile
+        if (across_move.tiles[i] == '.')
+        {
+            continue;
+        }
+
+        // Store the letter placed, its row, column,
+        // and number of letter points obtained without any bonuses
+        char letter = across_move.tiles[i];
+        int row = across_move.row;
+        int col = across_move.col + i;
+        int letter_pts = 0;
+        int col_cross_pts = 0;
+
+        // Only add points if the letter is uppercase (lowercase = blanks)
+        if (isupper(letter))
+        {
+            letter_pts = tiles[letter - 'A'].points;
+        }
+
+        // Account for double letter, or triple letter bonuses
+        // by multiplying the points obtained by the letter by 2 or 3
+        if ((*board)[row][col].type == double_letter)
+        {
+            letter_pts *= 2;
+        }
+        else if ((*board)[row][col].type == triple_letter)
+        {
+            letter_pts *= 3;
+        }
+
+        row_pts += letter_pts;
+
+        // Calculate the number of cross points
+        // Column cross points are points obtained by forming vertical words
+        // when playing a horizontal word across the board
+        if ((*board)[row-1][col].letter != '.' ||
+            (*board)[row+1][col].letter != '.')
+        {
+            col_cross_pts += calc_col_cross_pts(board, row, col);
+            col_cross_pts += letter_pts;
+        }
+
+        // Account for double or triple word bonuses
+        // by recording the number of word bonuses for the row points
+        // and multiplying the column cross points by 2 or 3
+        if ((*board)[row][col].type == double_word)
+        {
+            num_double_word++;
+            col_cross_pts *= 2;
+        }
+        else if ((*board)[row][col].type == triple_word)
+        {
+            num_triple_word++;
+            col_cross_pts *= 3;
+        }
+
+        total_cross_pts += col_cross_pts;
+    }
+
+    // Prepare to go through all the squares left of the move
+    int row = across_move.row;
+    int col = across_move.col - 1;
+
+    // Go through all the squares left of the first tile
+    // placed in the row for the move
+    while ((*board)[row][col].type != outside &&
+           (*board)[row][col].letter != '.')
+    {
+        char letter = (*board)[row][col].letter;
+
+        // Only add points if the letter is uppercase (lowercase = blanks)
+        if (isupper(letter))
+        {
+            row_pts += tiles[letter - 'A'].points;
+        }
+
+        col--;
+    }
+
+    // Prepare to go through all the squares in between the move
+    col = across_move.col;
+
+    // Go through all the squares in between the first and last tile
+    // placed in the row for the move
+    while (col < across_move.col + across_move.length)
+    {
+        char letter = (*board)[row][col].letter;
+
+        // Only add points if the letter is uppercase (lowercase = blanks)
+        if (isupper(letter))
+        {
+            row_pts += tiles[letter - 'A'].points;
+        }
+
+        col++;
+    }
+
+    // Prepare to go through all the squares right of the move
+    col = across_move.col + across_move.length;
+
+    // Go through all the squares right of the last tile
+    // placed in the row for the move
+    while ((*board)[row][col].type != outside &&
+           (*board)[row][col].letter != '.')
+    {
+        char letter = (*board)[row][col].letter;
+
+        // Only add points if the letter is uppercase (lowercase = blanks)
+        if (isupper(letter))
+        {
+            row_pts += tiles[letter - 'A'].points;
+        }
+
+        col++;
+    }
+
+    // Double the row points for a double word bonus
+    for (int i = 1; i <= num_double_word; i++)
+    {
+        row_pts *= 2;
+    }
+
+    // Triple the row points for a double word bonus
+    for (int i = 1; i <= num_triple_word; i++)
+    {
+        row_pts *= 3;
+    }
+
+    // If you use 7 tiles in your move, you get a bingo of 50 points
+    if (across_move.num_tiles >= 7)
+    {
+        return row_pts + total_cross_pts + 50;
+    }
+    else
+    {
+        return row_pts + total_cross_pts;
+    }
+
+}
+
+/**
+ * Calculates the number of points obtained from tiles above and below a square.
+ * Ex. Hypothetically, if the word "DRAG" and the tiles "M" and "O" are on the
+ *     board and then the word "cake" is create horizontally by adding the tiles
+ *     "C", "K", and "E". The function
+ *     returns the points obtained by placing the tiles "C", "K", and "e" only.
+ *
+ *     . D . . .          . D . . .
+ *     . R . M .   -->    . R . M .
+ *     * * * * *          C A K E D
+ *     . G . . O          . G . . O
+ *
+ * @param   board   a SquareGrid containing all the data for a Scrabble Board
+ *                  that is being played
+ * @param   row     the row number of the square above and below the function
+ *                  must calculate the number of column cross points
+ * @param   col     the column number of the square above and below the function
+ *                  must calculate the number of column cross points
+ * @return          the number of points obtained from tiles directly above
+ *                  and below a square
+ */
+int Engine::calc_col_cross_pts (const SquareGrid* board,
+                                int row, int col) const
+{
+    int col_cross_pts = 0;
+    int row_original = row;
+
+    // Start one row above the square
+    row = row_original - 1;
+
+    // Calculate points formed by letters above the square
+    while ((*board)[row][col].type != outside &&
+           (*board)[row][col].letter != '.')
+    {
+        char letter = (*board)[row][col].letter;
+
+        // Only add points if the letter is uppercase (lowercase = blanks)
+        if (isupper(letter))
+        {
+            col_cross_pts += tiles[letter - 'A'].points;
+        }
+
+        row--;
+    }
+
+    // Now, start on the row below the square
+    row = row_original + 1;
+
+    // Calculate points formed by letters below the square
+    while ((*board)[row][col].type != outside &&
+           (*board)[row][col].letter != '.')
+    {
+        char letter = (*board)[row][col].letter;
+
+        // Only add points if the letter is uppercase (lowercase = blanks)
+        if (isupper(letter))
+        {
+            col_cross_pts += tiles[letter - 'A'].points;
+        }
+
+        row++;
+    }
+
+    return col_cross_pts;
+}
+
+/**
+ * Calculates the number of points obtained for a given down move.
+ *
+ * @param   board       a pointer to the SquareGrid containing all the data for
+ *                      a Scrabble Board
+ * @param   down_move   the tiles placed for a given down move
+ * @return              the number of points obtained from a down move
+ */
+int Engine::calc_down_pts (const SquareGrid* board,
+                           const Move &down_move) const
+{
+    // Invert the board and the move
+    SquareGrid inverted_board = invert_board(*board);
+
+    return calc_across_pts(&inverted_board, invert_move(down_move));
+}
+
+// The squares of a SquareGrid as lines in either direction
+struct GridLines
+{
+    const SquareGrid &board;
+
+    const Square &at (int dir, int line, int pos) const
+    {
+        return (dir == ACROSS) ? board[line][pos] : board[pos][line];
+    }
+};
+
+// The squares of a BoardOverlay as lines in either direction. The lines of
+// the other direction are the lines of the other board of the overlay.
+struct OverlayLines
+{
+    const BoardOverlay &overlay;
+    int board_dir;      // ACROSS for boards[ACROSS], DOWN for boards[DOWN]
+
+    const Square &at (int dir, int line, int pos) const
+    {
+        return (*overlay.lines[board_dir ^ dir][line])[pos];
+    }
+};
+
+/**
+ * Fills in the data of one line of a ScoreTable that comes from the squares of
+ * the line: which squares are occupied, their premiums and the points of the
+ * tiles right before and after each square. The cross points of the line are
+ * not changed.
+ *
+ * @param   lines       gives the square at a position of a line in a
+ *                      direction
+ * @param   letter_pts  the points of each letter
+ * @param   dir         the direction of the line
+ * @param   line        the line to fill in
+ * @param   score_line  the ScoreLine of the line
+ */
+template <class Lines>
+static void fill_score_line (const Lines &lines, const int16_t* letter_pts,
+                             int dir, int line, ScoreLine &score_line)
+{
+    // Store the square's own data
+    for (int pos = 0; pos < GRID_SIZE; pos++)
+    {
+        const Square &sqr = lines.at(dir, line, pos);
+
+        score_line.occupied[pos] = (sqr.type != outside && sqr.letter != '.');
+        score_line.tile_pts[pos] = score_line.occupied[pos] ?
+                                   letter_pts[(int) sqr.letter] : 0;
+        score_line.letter_mult[pos] =
+            (sqr.type == triple_letter) ? 3 :
+            (sqr.type == double_letter) ? 2 : 1;
+        score_line.word_mult[pos] =
+            (sqr.type == triple_word) ? 3 :
+            (sqr.type == double_word) ? 2 : 1;
+    }
+
+    // Add up the points of the tiles right before each square
+    int run_pts = 0;
+
+    for (int pos = 0; pos < GRID_SIZE; pos++)
+    {
+        score_line.before_pts[pos] = run_pts;
+        run_pts = score_line.occupied[pos] ?
+                  run_pts + score_line.tile_pts[pos] : 0;
+    }
+
+    // Add up the points of the tiles right after each square
+    run_pts = 0;
+
+    for (int pos = GRID_SIZE - 1; pos >= 0; pos--)
+    {
+        score_line.after_pts[pos] = run_pts;
+        run_pts = score_line.occupied[pos] ?
+                  run_pts + score_line.tile_pts[pos] : 0;
+    }
+}
+
+/**
+ * Finds the cross points of a square from the ScoreLine of the line that
+ * crosses it, which are the points of the tiles on either side of it in the
+ * other direction.
+ *
+ * @param   cross_line  the ScoreLine of the line in the other direction
+ * @param   line        the square's line, which is its position in cross_line
+ * @param   cross_pts   set to the points of the tiles on either side
+ * @param   has_cross   set to whether there are tiles on either side
+ */
+static void find_cross_pts (const ScoreLine &cross_line, int line,
+                            int16_t &cross_pts, int8_t &has_cross)
+{
+    cross_pts = cross_line.before_pts[line] + cross_line.after_pts[line];
+    has_cross = cross_line.occupied[line - 1] ||
+                cross_line.occupied[line + 1];
+}
+
+/**
+ * Fills in the cross points of a ScoreTable from the points of its lines.
+ *
+ * @param   table   the table, whose lines have been filled in
+ */
+static void fill_cross_pts (ScoreTable &table)
+{
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        int other = 1 - dir;
+
+        for (int line = 1; line < GRID_SIZE - 1; line++)
+        {
+            ScoreLine &score_line = table.lines[dir][line];
+
+            for (int pos = 1; pos < GRID_SIZE - 1; pos++)
+            {
+                find_cross_pts(table.lines[other][pos], line,
+                               score_line.cross_pts[pos],
+                               score_line.has_cross[pos]);
+            }
+        }
+    }
+}
+
+/**
+ * Fills in a ScoreTable from the squares of a board, which may be stored in
+ * different ways.
+ *
+ * @param   lines       gives the square at a position of a line in a
+ *                      direction
+ * @param   letter_pts  the points of each letter
+ * @param   table       the table to fill in, passed by reference
+ */
+template <class Lines>
+static void fill_score_table (const Lines &lines, const int16_t* letter_pts,
+                              ScoreTable &table)
+{
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        for (int line = 0; line < GRID_SIZE; line++)
+        {
+            fill_score_line(lines, letter_pts, dir, line,
+                            table.lines[dir][line]);
+        }
+    }
+
+    fill_cross_pts(table);
+}
+
+/**
+ * Fills in a ScoreTable with the data needed to score plays on a board. The
+ * table is built once for a board and then shared by every play scored.
+ *
+ * @param   board   a SquareGrid containing all the data for a Scrabble Board
+ * @param   table   the table to fill in, passed by reference
+ */
+void Engine::build_score_table (const SquareGrid &board,
+                                ScoreTable &table) const
+{
+    GridLines lines = {board};
+    fill_score_table(lines, letter_pts, table);
+}
+
+/**
+ * Calculates the number of points obtained for a play using a ScoreTable.
+ * Gives the same points as calc_across_pts and calc_down_pts, but only looks
+ * at the squares of the play.
+ *
+ * @param   table   the ScoreTable of the board on which the play is made
+ * @param   play    the play to score
+ * @return          the number of points obtained from the play or -1 if the
+ *                  play is not on the board or places a tile on a tile
+ */
+int Engine::score_play (const ScoreTable &table, const Play &play) const
+{
+    int dir = play.direction;
+    int line = (dir == ACROSS) ? play.row : play.col;
+    int pos = (dir == ACROSS) ? play.col : play.row;
+
+    // Ensure the play is on the board
+    if ((dir != ACROSS && dir != DOWN) || play.length < 1 ||
+        line < 1 || line > GRID_SIZE - 2 ||
+        pos < 1 || pos + play.length - 1 > GRID_SIZE - 2)
+    {
+        return -1;
+    }
+
+    return score_line_play(table.lines[dir][line], pos, play);
+}
+
+/**
+ * Calculates the number of points obtained for a play along one line, using
+ * the ScoreLine of the line.
+ *
+ * @param   score_line  the ScoreLine of the line on which the play is made
+ * @param   pos         the position of the play's first square in the line,
+ *                      such that the play fits on the board
+ * @param   play        the play to score
+ * @return              the number of points obtained from the play or -1 if
+ *                      the play places a tile on a tile
+ */
+int Engine::score_line_play (const ScoreLine &score_line, int pos,
+                             const Play &play) const
+{
+    int last = pos + play.length - 1;
+    int main_pts = score_line.before_pts[pos] + score_line.after_pts[last];
+    int main_mult = 1;
+    int total_cross_pts = 0;
+    int num_placed = 0;
+
+    for (int i = 0; i < play.length; i++)
+    {
+        int index = pos + i;
+        char letter = play.tiles[i];
+
+        // Squares that already have a tile only add the tile's points
+        if (letter == '.')
+        {
+            if (!score_line.occupied[index])
+            {
+                return -1;
+            }
+
+            main_pts += score_line.tile_pts[index];
+            continue;
+        }
+
+        if (score_line.occupied[index] || !isalpha((unsigned char) letter))
+        {
+            return -1;
+        }
+
+        int placed_pts = letter_pts[(int) letter]
+                       * score_line.letter_mult[index];
+        main_pts += placed_pts;
+        main_mult *= score_line.word_mult[index];
+        total_cross_pts += score_line.has_cross[index]
+                         * score_line.word_mult[index]
+                         * (score_line.cross_pts[index] + placed_pts);
+        num_placed++;
+    }
+
+    // If you use 7 tiles in your move, you get a bingo of 50 points
+    int bingo_pts = (num_placed >= NUM_RACK_TILES) ? 50 : 0;
+
+    return main_pts * main_mult + total_cross_pts + bingo_pts;
+}
+
+/**
+ * Scores many plays on one board. The ScoreTable is built once and shared
+ * by every play.
+ *
+ * @param   board   a SquareGrid containing all the data for a Scrabble Board
+ * @param   plays   the plays to score
+ * @param   scores  set to the points of each play (-1 if it is not valid)
+ */
+void Engine::score_plays (const SquareGrid &board, const vector <Play> &plays,
+                          vector <int> &scores) const
+{
+    TraceSpan span ("score_plays", "scoring");
+    ScoreTable table;
+    build_score_table(board, table);
+
+    scores.resize(plays.size());
+
+    for (unsigned int i = 0; i < plays.size(); i++)
+    {
+        scores[i] = score_play(table, plays[i]);
+    }
+}
+
+/**
+ * Gets the word made across a line by placing a letter on a square, from the
+ * tiles right before the square to the tiles right after it.
+ *
+ * @param   board       a SquareGrid containing all the data for a Scrabble
+ *                      Board
+ * @param   row         the row of the square
+ * @param   col         the column of the square
+ * @param   letter      the letter placed on the square
+ * @param   direction   ACROSS for the word in the row, DOWN for the word in
+ *                      the column
+ * @return              the word in uppercase, or just the letter if there are
+ *                      no tiles on either side of the square
+ */
+static string get_line_word (const SquareGrid &board, int row, int col,
+                             char letter, int direction)
+{
+    int d_row = (direction == DOWN) ? 1 : 0;
+    int d_col = (direction == ACROSS) ? 1 : 0;
+    int start_row = row;
+    int start_col = col;
+
+    // Go back to the first tile of the word
+    while (board[start_row - d_row][start_col - d_col].letter != '.' &&
+           board[start_row - d_row][start_col - d_col].type != outside)
+    {
+        start_row -= d_row;
+        start_col -= d_col;
+    }
+
+    string word;
+
+    for (int r = start_row, c = start_col;
+         board[r][c].type != outside; r += d_row, c += d_col)
+    {
+        if (r == row && c == col)
+        {
+            word += (char) toupper(letter);
+        }
+        else if (board[r][c].letter != '.')
+        {
+            word += (char) toupper(board[r][c].letter);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return word;
+}
+
+/**
+ * Checks whether a play is legal: its tiles are in the rack, it makes one
+ * unbroken line that touches the tiles on the board (or covers the centre
+ * square on the first move), and every word it makes is in the lexicon.
+ *
+ * The work done is proportional to the length of the words made. The
+ * cross_check_mask of each square, set by update_board, is used for the
+ * words across an across play. The words across a down play are looked up
+ * in the lexicon.
+ *
+ * @param   board   a SquareGrid on which update_board has been called
+ * @param   play    the play to check
+ * @param   rack    the number of each tile in the rack ([26] = blanks)
+ * @return          play_ok, or the first error found and where it was found
+ */
+PlayCheck Engine::validate_play (const SquareGrid &board, const Play &play,
+                                 const vector <int> &rack) const
+{
+    PlayCheck check = {play_ok, play.row, play.col, ""};
+    int dir = play.direction;
+    int d_row = (dir == DOWN) ? 1 : 0;
+    int d_col = (dir == ACROSS) ? 1 : 0;
+    int last_row = play.row + d_row * (play.length - 1);
+    int last_col = play.col + d_col * (play.length - 1);
+
+    // Ensure the play is on the board
+    if ((dir != ACROSS && dir != DOWN) || play.length < 1 ||
+        play.length > NUM_BOARD_COLS ||
+        play.row < 1 || last_row > NUM_BOARD_ROWS ||
+        play.col < 1 || last_col > NUM_BOARD_COLS)
+    {
+        check.error = play_off_board;
+        return check;
+    }
+
+    int mid_row = NUM_BOARD_ROWS/2 + 1;
+    int mid_col = NUM_BOARD_COLS/2 + 1;
+    int tiles_used[27] = {0};
+    int num_placed = 0;
+    bool is_connected = false;
+    bool covers_centre = false;
+    bool has_cross_word = false;
+    int bad_cross_index = -1;   // The first tile that makes a bad cross word
+
+    for (int i = 0; i < play.length; i++)
+    {
+        int row = play.row + d_row * i;
+        int col = play.col + d_col * i;
+        char letter = play.tiles[i];
+        const Square &sqr = board[row][col];
+
+        check.row = row;
+        check.col = col;
+
+        // Squares that already have a tile keep the line unbroken
+        if (letter == '.')
+        {
+            if (sqr.letter == '.')
+            {
+                check.error = play_not_contiguous;
+                return check;
+            }
+
+            is_connected = true;
+            continue;
+        }
+
+        // A play from the C interface can hold any byte, which must not be
+        // passed to isalpha as a negative char
+        if (!isalpha((unsigned char) letter))
+        {
+            check.error = play_bad_letter;
+            return check;
+        }
+
+        if (sqr.letter != '.')
+        {
+            check.error = play_on_tile;
+            return check;
+        }
+
+        tiles_used[islower((unsigned char) letter) ? 26 : (letter - 'A')]++;
+        num_placed++;
+
+        if (row == mid_row && col == mid_col)
+        {
+            covers_centre = true;
+        }
+
+        // Ensure the tiles on either side of the square make a word with it
+        const Square &before = board[row - d_col][col - d_row];
+        const Square &after = board[row + d_col][col + d_row];
+
+        if ((before.letter == '.' || before.type == outside) &&
+            (after.letter == '.' || after.type == outside))
+        {
+            continue;
+        }
+
+        is_connected = true;
+        has_cross_word = true;
+
+        int letter_index = toupper((unsigned char) letter) - 'A';
+        bool is_valid = (dir == ACROSS) ?
+            (sqr.cross_check_mask >> letter_index & 1) :
+            is_word(get_line_word(board, row, col, letter, ACROSS));
+
+        if (!is_valid && bad_cross_index == -1)
+        {
+            bad_cross_index = i;
+        }
+    }
+
+    check.row = play.row;
+    check.col = play.col;
+
+    if (num_placed == 0)
+    {
+        check.error = play_no_tiles;
+        return check;
+    }
+
+    for (int i = 0; i < 27; i++)
+    {
+        if (tiles_used[i] > rack[i])
+        {
+            check.error = play_not_in_rack;
+            return check;
+        }
+    }
+
+    // The main word also includes the tiles right before and after the play
+    int first_row = play.row;
+    int first_col = play.col;
+
+    while (board[first_row - d_row][first_col - d_col].letter != '.' &&
+           board[first_row - d_row][first_col - d_col].type != outside)
+    {
+        first_row -= d_row;
+        first_col -= d_col;
+    }
+
+    string main_word;
+
+    for (int row = first_row, col = first_col;
+         row < play.row || col < play.col; row += d_row, col += d_col)
+    {
+        main_word += (char) toupper(board[row][col].letter);
+    }
+
+    for (int i = 0; i < play.length; i++)
+    {
+        char letter = (play.tiles[i] == '.') ?
+                      board[play.row + d_row * i][play.col + d_col * i].letter :
+                      play.tiles[i];
+        main_word += (char) toupper((unsigned char) letter);
+    }
+
+    for (int row = last_row + d_row, col = last_col + d_col;
+         board[row][col].letter != '.' && board[row][col].type != outside;
+         row += d_row, col += d_col)
+    {
+        main_word += (char) toupper(board[row][col].letter);
+    }
+
+    if ((int) main_word.length() > play.length)
+    {
+        is_connected = true;
+    }
+
+    // If the centre square is empty, then this is the first move
+    if (!is_connected)
+    {
+        check.error = (board[mid_row][mid_col].letter != '.') ?
+                      play_not_connected :
+                      (covers_centre ? play_ok : play_not_on_centre);
+
+        if (check.error != play_ok)
+        {
+            return check;
+        }
+    }
+
+    if (main_word.length() < 2 && !has_cross_word)
+    {
+        check.error = play_too_short;
+        return check;
+    }
+
+    if (main_word.length() >= 2 && !is_word(main_word))
+    {
+        check.error = play_bad_main_word;
+        check.word = main_word;
+        return check;
+    }
+
+    if (bad_cross_index != -1)
+    {
+        check.error = play_bad_cross_word;
+        check.row = play.row + d_row * bad_cross_index;
+        check.col = play.col + d_col * bad_cross_index;
+        check.word = get_line_word(board, check.row, check.col,
+                                   play.tiles[bad_cross_index], 1 - dir);
+    }
+
+    return check;
+}
+
+/**
+ * Inverts a board so that for each board[row][col] == inverted_board[col][row].
+ * In other words, it swaps rows and columns.
+ *
+ * @param   board       a pointer to the SquareGrid containing all the data for
+ *                      a Scrabble Board
+ * @return              the inverted board
+ */
+SquareGrid Engine::invert_board (const SquareGrid &board) const
+{
+    SquareGrid inverted_board;
+    invert_board(board, inverted_board);
+    return inverted_board;
+}
+
+/**
+ * Inverts a board into another board, reusing the memory of its squares if it
+ * already has the size of a board.
+ *
+ * @param   board           the board to invert
+ * @param   inverted_board  set to the inverted board
+ */
+void Engine::invert_board (const SquareGrid &board,
+                           SquareGrid &inverted_board) const
+{
+    // The squares outside of the board are copied as they are, and they are
+    // the same for every board
+    if (inverted_board.size() != board.size())
+    {
+        inverted_board = board;
+    }
+
+    // Invert the board by changing rows to columns and vice verse,
+    // so that for each Square in board,
+    // board[row][col] == inverted_board[col][row]
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            inverted_board[row][col] = board[col][row];
+            inverted_board[row][col].row = row;
+            inverted_board[row][col].col = col;
+        }
+    }
+
+    // Update the properties of the inverted board
+    update_down_cross_checks(inverted_board);
+    update_min_across_word_length(inverted_board);
+}
+
+/**
+ * Inverts a move so that it swaps the row and col of each square, which also
+ * swaps its direction. In other words, if the row and column of a square are
+ * 5 and 8 respectively, the row and column will become 8 and 5 .
+ *
+ * @param   across_move     the tiles placed for a given move
+ * @return                  a move with the rows and columns swapped for each
+ *                          square
+ */
+Move invert_move (Move across_move)
+{
+    Move down_move = across_move;
+    down_move.row = across_move.col;
+    down_move.col = across_move.row;
+    down_move.direction = (across_move.direction == ACROSS) ? DOWN : ACROSS;
+    return down_move;
+}
+
+/**
+ * Adds a move to the board by placing the appropriate tiles.
+ *
+ * @param   board   the state of the Scrabble board which is passed by reference
+ *                  since it is modified
+ * @param   _move   the move containing the tiles that have been placed
+ *
+ */
+void Engine::add_move_to_board (SquareGrid &board, const Move &_move) const
+{
+    for (int i = 0; i < _move.length; i++)
+    {
+        if (_move.tiles[i] != '.')
+        {
+            int row = _move.row + ((_move.direction == DOWN) ? i : 0);
+            int col = _move.col + ((_move.direction == ACROSS) ? i : 0);
+            board[row][col].letter = _move.tiles[i];
+        }
+    }
+
+    update_down_cross_checks(board);
+    update_min_across_word_length(board);
+}
+
+/**
+ * Plays a move on a board that update_board has been called on, and records
+ * what it changed so that undo_move can take it back. Only the rows and
+ * columns that the move's tiles affect are updated, and each square is
+ * recorded as it is changed, so the work done does not depend on the size of
+ * the board.
+ *
+ * @param   board   the board, which is modified
+ * @param   rack    the rack of the player making the move, from which its
+ *                  tiles are taken ('*' for a lowercase letter)
+ * @param   _move   the move to play
+ * @param   log     the move and the state of the squares it changed are
+ *                  added to the end
+ * @return          false if the rack does not have the move's tiles or a
+ *                  tile is placed on a square that is not empty, in which
+ *                  case nothing is changed
+ */
+bool Engine::do_move (SquareGrid &board, vector <int> &rack, const Move &_move,
+                      UndoLog &log) const
+{
+    int num_used [27] = {0};
+
+    for (int i = 0; i < _move.length; i++)
+    {
+        if (_move.tiles[i] == '.')
+        {
+            continue;
+        }
+
+        int row = _move.row + ((_move.direction == DOWN) ? i : 0);
+        int col = _move.col + ((_move.direction == ACROSS) ? i : 0);
+        int tile_index = isupper(_move.tiles[i]) ? _move.tiles[i] - 'A' : 26;
+
+        if (board[row][col].letter != '.' ||
+            ++num_used[tile_index] > rack[tile_index])
+        {
+            return false;
+        }
+    }
+
+    UndoRecord record;
+    record.move = _move;
+    record.first_square = log.squares.size();
+    log.moves.push_back(record);
+
+    bool changed_rows [NUM_BOARD_ROWS + 2] = {false};
+    bool changed_cols [NUM_BOARD_COLS + 2] = {false};
+    bool search_rows [NUM_BOARD_ROWS + 2] = {false};
+
+    for (int i = 0; i < _move.length; i++)
+    {
+        if (_move.tiles[i] == '.')
+        {
+            continue;
+        }
+
+        int row = _move.row + ((_move.direction == DOWN) ? i : 0);
+        int col = _move.col + ((_move.direction == ACROSS) ? i : 0);
+        Square &sqr = board[row][col];
+        log.squares.push_back({(uint8_t) row, (uint8_t) col, sqr.letter,
+                               (int8_t) sqr.min_across_word_length,
+                               sqr.cross_check_mask});
+
+        sqr.letter = _move.tiles[i];
+        changed_rows[row] = true;
+        changed_cols[col] = true;
+
+        rack[isupper(_move.tiles[i]) ? _move.tiles[i] - 'A' : 26]--;
+    }
+
+    update_changed_lines(*this, board, changed_rows, changed_cols,
+                         search_rows, &log.squares);
+
+    return true;
+}
+
+/**
+ * Takes back the last move played by do_move, restoring every square it
+ * changed and putting its tiles back in the rack. A square can be recorded
+ * more than once (its letter, then its cross-check or minimum word length),
+ * so the squares are restored from the last recorded to the first.
+ *
+ * @param   board   the board the move was played on, which is modified
+ * @param   rack    the rack the move's tiles were taken from
+ * @param   log     the log the move was recorded in. Its last move is
+ *                  removed.
+ */
+void Engine::undo_move (SquareGrid &board, vector <int> &rack,
+                        UndoLog &log) const
+{
+    if (log.moves.empty())
+    {
+        return;
+    }
+
+    const UndoRecord &record = log.moves.back();
+
+    for (size_t i = log.squares.size(); i > record.first_square; i--)
+    {
+        const UndoSquare &old_sqr = log.squares[i - 1];
+        Square &sqr = board[old_sqr.row][old_sqr.col];
+        sqr.letter = old_sqr.letter;
+        sqr.min_across_word_length = old_sqr.min_across_word_length;
+        sqr.cross_check_mask = old_sqr.cross_check_mask;
+    }
+
+    for (int i = 0; i < record.move.length; i++)
+    {
+        char tile = record.move.tiles[i];
+
+        if (tile != '.')
+        {
+            rack[isupper(tile) ? tile - 'A' : 26]++;
+        }
+    }
+
+    log.squares.resize(record.first_square);
+    log.moves.pop_back();
+}
+
+/**
+ * Makes a BoardSnapshot of a board, which simulation workers then start from.
+ *
+ * @param   board       the state of the Scrabble board. Only its letters are
+ *                      used, so update_board need not have been called.
+ * @param   snapshot    set to the boards and ScoreTables of the position
+ */
+void Engine::make_snapshot (const SquareGrid &board,
+                            BoardSnapshot &snapshot) const
+{
+    TraceSpan span ("make_snapshot", "board");
+
+    snapshot.boards[ACROSS] = layout;
+
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            snapshot.boards[ACROSS][row][col].letter = board[row][col].letter;
+        }
+    }
+
+    update_board(snapshot.boards[ACROSS]);
+    invert_board(snapshot.boards[ACROSS], snapshot.boards[DOWN]);
+
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        build_score_table(snapshot.boards[dir], snapshot.tables[dir]);
+    }
+
+    snapshot.num_tiles = count_board_tiles(board);
+}
+
+/**
+ * Starts an overlay from a snapshot, which undoes the moves played on it.
+ * Only the pointers to the lines and ScoreLines are set, and the ones that the
+ * overlay copied are kept to be overwritten by later moves.
+ *
+ * @param   snapshot    the position to start from, which must outlive the
+ *                      overlay's use of it
+ * @param   overlay     the overlay to start
+ */
+void reset_overlay (const BoardSnapshot &snapshot, BoardOverlay &overlay)
+{
+    overlay.snapshot = &snapshot;
+    overlay.num_tiles = snapshot.num_tiles;
+
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        for (int line = 0; line < GRID_SIZE; line++)
+        {
+            overlay.lines[dir][line] = &snapshot.boards[dir][line];
+            overlay.score_lines[dir][line] =
+                                    &snapshot.tables[dir].lines[ACROSS][line];
+        }
+    }
+}
+
+/**
+ * Returns a square of an overlay so that it can be changed. Its line is
+ * copied from the snapshot first if the overlay does not have its own copy.
+ *
+ * @param   overlay     the overlay
+ * @param   dir         ACROSS for boards[ACROSS], DOWN for boards[DOWN]
+ * @param   line        the row of the square on that board
+ * @param   pos         the column of the square on that board
+ * @return              the square in the overlay's own copy of the line
+ */
+static Square &get_own_square (BoardOverlay &overlay, int dir, int line,
+                               int pos)
+{
+    SquareRow &own_line = overlay.own_lines[dir][line];
+
+    if (overlay.lines[dir][line] != &own_line)
+    {
+        own_line = *overlay.lines[dir][line];
+        overlay.lines[dir][line] = &own_line;
+        overlay.lines_copied++;
+    }
+
+    return own_line[pos];
+}
+
+/**
+ * Returns the across ScoreLine of a line of an overlay so that it can be
+ * changed. It is copied from the snapshot first if the overlay does not have
+ * its own copy.
+ *
+ * @param   overlay     the overlay
+ * @param   dir         ACROSS for boards[ACROSS], DOWN for boards[DOWN]
+ * @param   line        the row of that board
+ * @return              the overlay's own copy of the ScoreLine
+ */
+static ScoreLine &get_own_score_line (BoardOverlay &overlay, int dir,
+                                      int line)
+{
+    ScoreLine &own_line = overlay.own_score_lines[dir][line];
+
+    if (overlay.score_lines[dir][line] != &own_line)
+    {
+        own_line = *overlay.score_lines[dir][line];
+        overlay.score_lines[dir][line] = &own_line;
+        overlay.score_lines_copied++;
+    }
+
+    return own_line;
+}
+
+/**
+ * Plays a move on an overlay. Its tiles are placed on both boards, and the
+ * cross-checks of only the columns with new tiles and the minimum word
+ * lengths of only the rows with new tiles (and the rows next to them) are
+ * updated. The ScoreLines of only the lines with new tiles are filled in
+ * again, along with the cross points of the squares that those lines cross.
+ * A line or ScoreLine is only copied from the snapshot if it changes.
+ *
+ * @param   overlay     the position, which reset_overlay has been called on
+ * @param   _move       the move to play
+ */
+void Engine::add_move_to_overlay (BoardOverlay &overlay,
+                                  const Move &_move) const
+{
+    TraceSpan span ("add_move_to_overlay", "board");
+
+    // The rows of boards[ACROSS] and boards[DOWN] with new tiles, including
+    // the outside rows
+    bool changed_lines [2][GRID_SIZE] = {{false}};
+
+    for (int i = 0; i < _move.length; i++)
+    {
+        if (_move.tiles[i] != '.')
+        {
+            int row = _move.row + ((_move.direction == DOWN) ? i : 0);
+            int col = _move.col + ((_move.direction == ACROSS) ? i : 0);
+            get_own_square(overlay, ACROSS, row, col).letter = _move.tiles[i];
+            get_own_square(overlay, DOWN, col, row).letter = _move.tiles[i];
+            changed_lines[ACROSS][row] = true;
+            changed_lines[DOWN][col] = true;
+            overlay.num_tiles++;
+        }
+    }
+
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        const SquareRow* const* lines = overlay.lines[dir];
+
+        // The cross-checks of a column only depend on its own tiles. The
+        // columns of one board are the rows of the other.
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            if (!changed_lines[1 - dir][col])
+            {
+                continue;
+            }
+
+            for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+            {
+                const Square &sqr = (*lines[row])[col];
+
+                if (sqr.letter != '.')
+                {
+                    continue;
+                }
+
+                uint32_t valid_letters = find_col_cross_check(lines, row, col);
+
+                if (valid_letters != sqr.cross_check_mask)
+                {
+                    get_own_square(overlay, dir, row, col).cross_check_mask =
+                        valid_letters;
+                }
+            }
+        }
+
+        // The minimum word lengths of a row depend on its own tiles and on
+        // the tiles of the rows above and below it
+        for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+        {
+            if (!changed_lines[dir][row - 1] && !changed_lines[dir][row] &&
+                !changed_lines[dir][row + 1])
+            {
+                continue;
+            }
+
+            int lengths [GRID_SIZE];
+            find_row_min_lengths(*lines[row - 1], *lines[row],
+                                 *lines[row + 1], lengths);
+
+            for (int col = 1; col <= NUM_BOARD_COLS; col++)
+            {
+                if ((*lines[row])[col].min_across_word_length != lengths[col])
+                {
+                    get_own_square(overlay, dir, row, col)
+                        .min_across_word_length = lengths[col];
+                }
+            }
+        }
+    }
+
+    // The ScoreLines of the lines with new tiles are filled in again. A row
+    // of one board is a column of the other, so the down ScoreLines of a
+    // board's ScoreTable are the across ScoreLines of the other board.
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        OverlayLines lines = {overlay, dir};
+
+        for (int line = 1; line <= NUM_BOARD_ROWS; line++)
+        {
+            if (changed_lines[dir][line])
+            {
+                fill_score_line(lines, letter_pts, ACROSS, line,
+                                get_own_score_line(overlay, dir, line));
+            }
+        }
+    }
+
+    // The cross points of a square only depend on the line that crosses it,
+    // so only the squares crossed by a line with new tiles can change
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        for (int pos = 1; pos <= NUM_BOARD_COLS; pos++)
+        {
+            if (!changed_lines[1 - dir][pos])
+            {
+                continue;
+            }
+
+            const ScoreLine &cross_line = *overlay.score_lines[1 - dir][pos];
+
+            for (int line = 1; line <= NUM_BOARD_ROWS; line++)
+            {
+                const ScoreLine &score_line = *overlay.score_lines[dir][line];
+                int16_t cross_pts;
+                int8_t has_cross;
+                find_cross_pts(cross_line, line, cross_pts, has_cross);
+
+                if (cross_pts != score_line.cross_pts[pos] ||
+                    has_cross != score_line.has_cross[pos])
+                {
+                    ScoreLine &own_line = get_own_score_line(overlay, dir,
+                                                             line);
+                    own_line.cross_pts[pos] = cross_pts;
+                    own_line.has_cross[pos] = has_cross;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Converts the letters on the board into a string of
+ * NUM_BOARD_ROWS * NUM_BOARD_COLS characters, row by row.
+ *
+ * @param   board   the state of the Scrabble board
+ * @return          a string containing every letter on the board
+ *                  ('.' = empty square, lowercase = blank tile)
+ */
+string board_to_string (SquareGrid &board)
+{
+    string letters;
+
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            letters += board[row][col].letter;
+        }
+    }
+
+    return letters;
+}
+
+/**
+ * Fills the board with letters stored in a string created by board_to_string.
+ *
+ * @param   letters     a string containing every letter on the board
+ * @param   board       the state of the Scrabble board which is passed by
+ *                      reference since it is modified
+ */
+void string_to_board (const string &letters, SquareGrid &board)
+{
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            board[row][col].letter = letters[(row-1)*NUM_BOARD_COLS + col-1];
+        }
+    }
+}
+
+/**
+ * @param   board   the state of the Scrabble board
+ * @return          the number of tiles that have been placed on the board
+ */
+int count_board_tiles (const SquareGrid &board)
+{
+    int num_tiles = 0;
+
+    for (int row = 1; row <= NUM_BOARD_ROWS; row++)
+    {
+        for (int col = 1; col <= NUM_BOARD_COLS; col++)
+        {
+            if (board[row][col].letter != '.')
+            {
+                num_tiles++;
+            }
+        }
+    }
+
+    return num_tiles;
+}
+
+/**
+ * Gets a description of why a play is not legal.
+ *
+ * @param   error   the error returned by validate_play
+ * @return          the description
+ */
+const char* play_error_message (PlayError error)
+{
+    switch (error)
+    {
+        case play_ok:             return "The play is legal";
+        case play_off_board:      return "The play does not fit on the board";
+        case play_bad_letter:     return "A tile is not a letter";
+        case play_on_tile:        return "A tile is placed on another tile";
+        case play_not_contiguous: return "The tiles are not in one line";
+        case play_no_tiles:       return "No tiles are placed";
+        case play_not_in_rack:    return "The tiles are not in the rack";
+        case play_not_connected:  return "The play does not touch any tiles";
+        case play_not_on_centre:  return "The first move must cover the "
+                                         "centre square";
+        case play_too_short:      return "The play does not make a word";
+        case play_bad_main_word:  return "The word is not in the lexicon";
+        case play_bad_cross_word: return "A word made across the play is not "
+                                         "in the lexicon";
+    }
+
+    return "Unknown error";
+}
+
+/**
+ * Describes the result of validating a play along with where the error was
+ * found, ex. "(8, 9) The word is not in the lexicon: QAT".
+ *
+ * @param   check   the result of validate_play
+ * @return          the description
+ */
+string describe_play_check (const PlayCheck &check)
+{
+    string description = "(" + to_string(check.row) + ", "
+                       + to_string(check.col) + ") "
+                       + play_error_message(check.error);
+
+    if (check.word != "")
+    {
+        description += ": " + check.word;
+    }
+
+    return description;
+}
+
+/**
+ * Counts the nodes, child pointers, and bytes used by a trie. A node shared by
+ * several branches of a word graph is only counted once.
+ *
+ * @param   node        the root of the trie (or subtrie) to measure
+ * @param   num_nodes   incremented by the number of nodes
+ * @param   num_edges   incremented by the number of child pointers
+ * @param   num_bytes   incremented by the bytes used by the nodes
+ */
+void measure_trie (const TrieNode* node, long long &num_nodes,
+                   long long &num_edges, long long &num_bytes)
+{
+    unordered_set <const TrieNode*> nodes;
+    collect_trie_nodes(node, nodes);
+
+    for (auto itr = nodes.begin(); itr != nodes.end(); itr++)
+    {
+        num_nodes++;
+        num_edges += (*itr)->children.size();
+        num_bytes += sizeof(TrieNode)
+                   + (*itr)->children.capacity() * sizeof(TrieNode*)
+                   + (*itr)->letter_indexes.capacity() * sizeof(int);
+    }
+}
+
+/**
+ * @param   cache   a MoveCache
+ * @return          the number of bytes used by the cache and its rows
+ */
+long long measure_move_cache (const MoveCache &cache)
+{
+    long long num_bytes = cache.rows.bucket_count() * sizeof(void*);
+
+    for (auto itr = cache.rows.begin(); itr != cache.rows.end(); itr++)
+    {
+        num_bytes += sizeof(pair <const string, Move>) + 2 * sizeof(void*)
+                   + itr->first.capacity() + 1;
+    }
+
+    return num_bytes;
+}
+
+/**
+ * @param   board   a SquareGrid containing the data for the state of the game
+ * @return          the number of bytes used by the board and its squares
+ */
+long long measure_board (const SquareGrid &board)
+{
+    long long num_bytes = board.capacity() * sizeof(SquareRow);
+
+    for (unsigned int row = 0; row < board.size(); row++)
+    {
+        num_bytes += board[row].capacity() * sizeof(Square);
+    }
+
+    return num_bytes;
+}
+
+/**
+ * @param   moves   a MoveList
+ * @return          the number of bytes used by the list, its boards and its
+ *                  moves
+ */
+long long measure_move_list (const MoveList &moves)
+{
+    long long num_bytes = sizeof(MoveList)
+                        + moves.rack.capacity() * sizeof(int);
+
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        num_bytes += measure_board(moves.boards[dir]);
+    }
+
+    return num_bytes;
+}
+
+/**
+ * @param   pool    a SearchPool
+ * @return          the number of bytes used by the pool, its boards and its
+ *                  buffers
+ */
+long long measure_search_pool (const SearchPool &pool)
+{
+    long long num_bytes = sizeof(SearchPool)
+                        + pool.rack.capacity() * sizeof(int)
+                        + pool.row_key.capacity();
+
+    for (int dir = ACROSS; dir <= DOWN; dir++)
+    {
+        num_bytes += measure_board(pool.boards[dir]);
+    }
+
+    return num_bytes;
+}
+
+/**
+ * Estimates the number of bytes used by each part of the engine.
+ *
+ * @return  a vector of MemoryEntries, one for each part of the program
+ */
+MemoryReport Engine::build_memory_report () const
+{
+    MemoryReport report;
+    MemoryEntry entry;
+
+    // The word graph used to generate moves, the alphagram index and the
+    // hook tables are in the lexicon image. If it was mapped from a file,
+    // they are shared with every other process that maps the file.
+    string shared = (image.file_name != "") ? " (shared)" : "";
+    entry.name = "lexicon nodes" + shared;
+    entry.count = lexicon.num_nodes;
+    entry.bytes = (long long) lexicon.num_nodes * sizeof(FlatNode);
+    report.push_back(entry);
+
+    entry.name = "lexicon edges" + shared;
+    entry.count = lexicon.num_children;
+    entry.bytes = (long long) lexicon.num_children * sizeof(uint32_t);
+    report.push_back(entry);
+
+    entry.name = "branch summaries" + shared;
+    entry.count = lexicon.num_nodes;
+    entry.bytes = (long long) lexicon.num_nodes * sizeof(BranchSummary);
+    report.push_back(entry);
+
+    entry.name = "alphagram index" + shared;
+    entry.count = alphagrams.num_words;
+    entry.bytes = measure_alphagram_index(alphagrams);
+    report.push_back(entry);
+
+    entry.name = "hook tables" + shared;
+    entry.count = 26 + alphagrams.num_words;
+    entry.bytes = entry.count * sizeof(WordHooks);
+    report.push_back(entry);
+
+    entry.name = "tile data";
+    entry.count = tiles.size();
+    entry.bytes = tiles.capacity() * sizeof(Tile);
+    report.push_back(entry);
+
+    SquareGrid board = new_board();
+    entry.name = "board";
+    entry.count = 1;
+    entry.bytes = measure_board(board);
+    report.push_back(entry);
+
+    // A search without a SearchPool makes its own copy of the board (the
+    // inverted board or the board of the first move), and the boards of a
+    // pool are measured by measure_search_pool. extend_right keeps an
+    // ExtendFrame and a letter for each square of the word.
+    long long stack_bytes = (NUM_BOARD_COLS + 1) * (sizeof(ExtendFrame) + 1);
+    entry.name = "search state per thread";
+    entry.count = 1;
+    entry.bytes = measure_board(board) + stack_bytes;
+    report.push_back(entry);
+
+    return report;
+}
@@ -0,0 +1,465 @@
+/**
+ * scrabble_engine.h
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Declares the Engine, which owns a lexicon, a set of tiles and a
+ *          board layout, and finds, scores and validates Scrabble moves.
+ *          The console program, the benchmark and any other tool link against
+ *          it. Several engines with different files can be used at once.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#ifndef SCRABBLE_ENGINE_H
+#define SCRABBLE_ENGINE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "scrabble_alphagram.h"
+#include "scrabble_image.h"
+#include "scrabble_lexicon.h"
+
+#define TILES_FILE_NAME "tiles.txt"
+#define WORDS_FILE_NAME "jonbcard_github_words.txt"
+#define BOARD_FILE_NAME "board.txt"
+#define NUM_BOARD_ROWS 15
+#define NUM_BOARD_COLS 15
+#define NUM_RACK_TILES 7
+#define GRID_SIZE (NUM_BOARD_ROWS + 2)    // Includes the outside squares
+#define ACROSS 0
+#define DOWN 1
+#define MAX_CACHED_ROWS 100000    // The default size of a MoveCache
+
+using namespace std;
+
+enum SquareType
+{
+    triple_word,
+    double_word,
+    triple_letter,
+    double_letter,
+    regular,
+    outside
+};
+
+struct Square
+{
+    SquareType type;
+    uint32_t cross_check_mask;  // The letters that make a word down the
+                                // square's column, as a mask where bit 0 is
+                                // 'A' and bit 25 is 'Z'
+    char letter; // Special values: '.' = empty square and
+                 //                 lowercase letter = blank tile
+    int row;
+    int col;
+    int min_across_word_length;
+};
+
+struct Tile
+{
+    char letter;
+    int points;
+    int total;
+};
+
+// The letters that can be put before (front) or after (back) a word to make
+// another word, as masks where bit 0 is 'A' and bit 25 is 'Z'
+struct WordHooks
+{
+    uint32_t front;
+    uint32_t back;
+};
+
+// A move found by the search. It has a fixed size and no pointers, so lists
+// of moves are cheap to build, copy and sort. A move with a length of 0 is no
+// move.
+struct Move
+{
+    int32_t score;
+    uint8_t row;            // The row of the first tile placed
+    uint8_t col;            // The column of the first tile placed
+    uint8_t direction;      // ACROSS or DOWN
+    uint8_t length;         // The number of squares in tiles
+    uint8_t num_tiles;      // The number of tiles placed from the rack
+
+    // The letter placed on each square from the first tile placed to the last
+    // tile placed, ending with '\0'. Special values: '.' = square already has
+    // a tile and lowercase letter = blank tile
+    char tiles [NUM_BOARD_COLS + 1];
+};
+
+// Remembers the best move of each row searched, keyed by everything that the
+// search of a row depends on: its letters, cross-checks, premiums, the points
+// of the tiles above and below it, and the rack. It is owned by the caller and
+// kept between searches, so a row that has not changed since a previous
+// search is not searched again. A cache must only be used with one engine.
+// The key does not include the row's number, so the row of a cached move is
+// replaced by the row that it is found for.
+struct MoveCache
+{
+    unordered_map <string, Move> rows;
+    size_t max_rows;    // The rows are cleared when there are more than this
+    long long hits;
+    long long misses;
+};
+
+struct SearchPool;
+
+// The mutable state of one call to the engine. The engine is never modified
+// after it has been constructed, so any number of threads can share one engine
+// as long as each thread uses its own SearchContext.
+struct SearchContext
+{
+    long long trie_edges_visited;   // Trie edges followed by extend_right
+    MoveCache* move_cache;          // NULL to search every row
+    SearchPool* pool;               // NULL to allocate the scratch space of
+                                    // each search
+};
+
+// A move proposed from outside the engine, such as a player's move
+struct Play
+{
+    int row;            // The row of the first tile placed
+    int col;            // The column of the first tile placed
+    int direction;      // ACROSS or DOWN
+    int length;         // The number of squares in tiles
+
+    // The letter placed on each square from the first tile placed to the last
+    // tile placed. Special values: '.' = square already has a tile and
+    //                              lowercase letter = blank tile
+    char tiles[NUM_BOARD_COLS + 1];
+};
+
+// Why a play is not legal. The values are also used by the C interface, so new
+// values must be added at the end.
+enum PlayError
+{
+    play_ok,
+    play_off_board,         // The play does not fit on the board
+    play_bad_letter,        // A tile is not a letter or '.'
+    play_on_tile,           // A tile is placed on a square that has a tile
+    play_not_contiguous,    // A '.' is on an empty square
+    play_no_tiles,          // No tile is placed
+    play_not_in_rack,       // A tile is not in the rack
+    play_not_connected,     // No tile is next to a tile on the board
+    play_not_on_centre,     // The first move does not cover the centre square
+    play_too_short,         // No word of 2 or more letters is made
+    play_bad_main_word,     // The word along the play is not in the lexicon
+    play_bad_cross_word     // A word across the play is not in the lexicon
+};
+
+// The result of validating a play
+struct PlayCheck
+{
+    PlayError error;
+    int row;            // The square where the error was found
+    int col;
+    string word;        // The word that is not in the lexicon, if any
+};
+
+// The data of the squares of one line of a board that is needed to score
+// plays along it, in arrays indexed by the position in the line
+struct ScoreLine
+{
+    int8_t occupied [GRID_SIZE];
+    int8_t letter_mult [GRID_SIZE];
+    int8_t word_mult [GRID_SIZE];
+    int8_t has_cross [GRID_SIZE];   // Tiles on either side
+    int16_t tile_pts [GRID_SIZE];   // Points of the tile on it
+    int16_t before_pts [GRID_SIZE]; // Points of the tiles right before it in
+                                    // the line
+    int16_t after_pts [GRID_SIZE];  // Points of the tiles right after it in
+                                    // the line
+    int16_t cross_pts [GRID_SIZE];  // Points of the tiles on either side of it
+};
+
+// The data of every square of a board that is needed to score plays, as a
+// ScoreLine for each [direction][line]. A line is a row for ACROSS and a
+// column for DOWN, so the squares of a down play are next to each other in
+// memory just like those of an across play, and a line can be filled in
+// again on its own.
+struct ScoreTable
+{
+    ScoreLine lines [2][GRID_SIZE];
+};
+
+// One square of the word that extend_right is building. A word spans at most
+// NUM_BOARD_COLS squares, so the frames fit in a fixed array.
+struct ExtendFrame
+{
+    uint32_t node;          // The node reached by the squares before this one
+    uint32_t letters;       // The children still to be tried on this square
+    uint32_t rack_mask;     // The tiles left in the rack
+    int tile;               // The tile taken from the rack for this square
+                            // (-1 if none)
+    int main_pts;           // The points of the main word so far
+    int main_mult;          // The word multiplier of the main word so far
+    int cross_pts;          // The points of the cross words so far
+    int num_tiles;          // The number of tiles placed so far
+};
+
+// The number of bytes used by one part of the program
+struct MemoryEntry
+{
+    string name;
+    long long bytes;
+    long long count;    // The number of objects (ex. nodes) in that part
+};
+
+typedef vector <Square> SquareRow;
+typedef vector <SquareRow> SquareGrid;
+typedef vector <MemoryEntry> MemoryReport;
+
+// The best move of every row and column of a board for one rack. It is owned
+// by the caller and kept between searches. When the board or rack changes,
+// only the rows and columns whose letters, cross-checks, minimum word lengths
+// or cross points changed are searched again.
+struct MoveList
+{
+    bool is_valid {false};  // False until a board with tiles is searched
+    vector <int> rack;
+
+    // The board searched for across moves and its inverted board, which is
+    // searched for down moves, along with their ScoreTables
+    SquareGrid boards [2];
+    ScoreTable tables [2];
+
+    // The best move of each line of boards[ACROSS] and boards[DOWN]. A down
+    // move is stored as it is placed on the inverted board.
+    Move line_moves [2][NUM_BOARD_ROWS + 1];
+
+    Move best_move {};
+    long long lines_searched {0};
+    long long lines_kept {0};     // Lines whose best move was reused
+};
+
+// The scratch space of a search. It is owned by the caller, one for each
+// thread, and kept between searches. Its boards and buffers are overwritten
+// rather than freed, so once they have grown to their size a search that uses
+// a pool and no MoveCache makes no heap allocations. A search with a
+// MoveCache still allocates a key and a map entry for each row that is not in
+// the cache.
+struct SearchPool
+{
+    // A copy of the board searched, whose minimum word lengths are changed for
+    // the first move, and the inverted board searched for down moves
+    SquareGrid boards [2];
+    vector <int> rack;      // The tiles that extend_right takes from the rack
+                            // and puts back
+    string row_key;         // The key of a row looked up in a MoveCache
+};
+
+// The state of a square before do_move changed it
+struct UndoSquare
+{
+    uint8_t row;
+    uint8_t col;
+    char letter;
+    int8_t min_across_word_length;
+    uint32_t cross_check_mask;
+};
+
+// A move played by do_move. The squares it changed are log.squares[first]
+// up to the first square of the next move (or the end), in the order in which
+// they were changed.
+struct UndoRecord
+{
+    Move move;
+    uint32_t first_square;
+};
+
+// The moves played by do_move that have not been undone, most recent last,
+// with the squares that each one changed. It is kept by the caller, and its
+// memory is reused, so playing and undoing moves makes no heap allocations
+// once it has grown.
+struct UndoLog
+{
+    vector <UndoRecord> moves;
+    vector <UndoSquare> squares;
+};
+
+// A position that many simulation workers start from: the board searched for
+// across moves and its inverted board, with their cross-checks and minimum
+// word lengths (which give the squares that words can start from), and their
+// ScoreTables. It is made once by make_snapshot and only read after that, so
+// the workers of every thread can share one snapshot.
+struct BoardSnapshot
+{
+    SquareGrid boards [2];
+    ScoreTable tables [2];
+    int num_tiles {0};
+};
+
+// A worker's position: a BoardSnapshot with the moves that the worker has
+// played on it. Each line of the two boards is read from the snapshot until a
+// move changes it, and is then copied into the overlay. The overlay is kept by
+// the worker and its memory is reused, so starting from the snapshot again
+// only resets the pointers to the lines. It points into itself, so it is not
+// copied.
+struct BoardOverlay
+{
+    BoardOverlay () = default;
+    BoardOverlay (const BoardOverlay &) = delete;
+    BoardOverlay &operator = (const BoardOverlay &) = delete;
+
+    const BoardSnapshot* snapshot {NULL};
+    int num_tiles {0};
+
+    // The rows of boards[ACROSS] and boards[DOWN] and the across ScoreLines
+    // of their ScoreTables, in the snapshot or in own_lines and
+    // own_score_lines
+    const SquareRow* lines [2][GRID_SIZE];
+    const ScoreLine* score_lines [2][GRID_SIZE];
+
+    // The lines and ScoreLines that moves changed
+    SquareRow own_lines [2][GRID_SIZE];
+    ScoreLine own_score_lines [2][GRID_SIZE];
+    long long lines_copied {0};
+    long long score_lines_copied {0};
+};
+
+class Engine
+{
+public:
+    Engine (string words_file_name = WORDS_FILE_NAME,
+            string tiles_file_name = TILES_FILE_NAME,
+            string board_file_name = BOARD_FILE_NAME);
+
+    // An engine holds a whole lexicon, so it is not copied by accident
+    Engine (const Engine &) = delete;
+    Engine &operator = (const Engine &) = delete;
+
+    SquareGrid new_board () const;
+    const vector <Tile> &get_tiles () const;
+    bool is_word (string word) const;
+    size_t get_num_words () const;
+    const FlatLexicon &get_lexicon () const;
+    const BranchSummary* get_branches () const;
+    const AlphagramIndex &get_alphagram_index () const;
+    WordHooks get_hooks (const string &fragment) const;
+    bool save_lexicon_image (string file_name, NodeLayout layout,
+                             string &error) const;
+    bool is_lexicon_current () const;
+    const string &get_load_errors () const;
+
+    void update_board (SquareGrid &board) const;
+    void update_down_cross_checks (SquareGrid &board) const;
+    void update_min_across_word_length (SquareGrid &board) const;
+    void update_col_down_cross_checks (SquareGrid &board, int col) const;
+    void update_row_min_across_word_length (SquareGrid &board, int row) const;
+    void add_move_to_board (SquareGrid &board, const Move &_move) const;
+    bool do_move (SquareGrid &board, vector <int> &rack, const Move &_move,
+                  UndoLog &log) const;
+    void undo_move (SquareGrid &board, vector <int> &rack,
+                    UndoLog &log) const;
+    void make_snapshot (const SquareGrid &board,
+                        BoardSnapshot &snapshot) const;
+    void add_move_to_overlay (BoardOverlay &overlay, const Move &_move) const;
+
+    void find_best_move (const SquareGrid &board, const vector <int> &rack,
+                         Move &best_move) const;
+    void find_best_move (const SquareGrid &board, const vector <int> &rack,
+                         Move &best_move, SearchContext &context) const;
+    void update_move_list (const SquareGrid &board, const vector <int> &rack,
+                           MoveList &moves, SearchContext &context) const;
+    void find_best_overlay_move (const BoardOverlay &overlay,
+                                 const vector <int> &rack, Move &best_move,
+                                 SearchContext &context) const;
+    Move find_best_across_move (const SquareGrid &board,
+                                const vector <int> &rack,
+                                SearchContext &context) const;
+    Move find_best_down_move (const SquareGrid &board,
+                              const vector <int> &rack,
+                              SearchContext &context) const;
+
+    int calc_across_pts (const SquareGrid* board,
+                         const Move &across_move) const;
+    int calc_down_pts (const SquareGrid* board, const Move &down_move) const;
+
+    void build_score_table (const SquareGrid &board, ScoreTable &table) const;
+    int score_play (const ScoreTable &table, const Play &play) const;
+    void score_plays (const SquareGrid &board, const vector <Play> &plays,
+                      vector <int> &scores) const;
+
+    PlayCheck validate_play (const SquareGrid &board, const Play &play,
+                             const vector <int> &rack) const;
+
+    MemoryReport build_memory_report () const;
+
+private:
+    // The lexicon image that the tables below point into. It is mapped from
+    // a lexicon image file, or made in memory from a text file of words.
+    LexiconImage image;
+    FlatLexicon lexicon;    // The word graph walked by extend_right
+    const BranchSummary* branches = NULL;   // Indexed by the lexicon's nodes
+    AlphagramIndex alphagrams;
+
+    // The hooks of each letter ([0] to [25]) and then of each word in the
+    // order of the alphagram index's word_offsets
+    const WordHooks* hooks = NULL;
+    vector <Tile> tiles;
+    int16_t letter_pts [128];   // The points of each letter, by its character
+                                // (0 for a lowercase letter made with a blank)
+    SquareGrid layout;      // The empty board read from the board file
+
+    // The files that could not be read when the engine was constructed, one
+    // line each. The engine does not output them, so that a program that
+    // uses it as a library keeps its own output.
+    string load_errors;
+
+    string read_word_data (string file_name);
+    void build_lexicon_image (const string &word_text);
+    bool read_lexicon_tables ();
+    vector <Tile> read_tile_data (string file_name);
+    SquareGrid read_board_data (string file_name);
+    void extend_right (const SquareRow &row_squares,
+                       const ScoreLine &score_line, vector <int> &rack,
+                       int row, int col, int min_word_length,
+                       Move &best_move, SearchContext &context) const;
+    void find_best_row_move (const SquareRow &squares,
+                             const vector <int> &rack,
+                             const ScoreLine &score_line, int row,
+                             Move &best_move, SearchContext &context) const;
+    void find_best_two_letter_move (const SquareRow &squares,
+                                    const vector <int> &rack,
+                                    const ScoreLine &score_line, int row,
+                                    bool is_first_move,
+                                    Move &best_move) const;
+    int score_line_play (const ScoreLine &score_line, int pos,
+                         const Play &play) const;
+    int calc_col_cross_pts (const SquareGrid* board, int row, int col) const;
+    uint32_t find_col_cross_check (const SquareRow* const* rows, int row,
+                                   int col) const;
+    SquareGrid invert_board (const SquareGrid &board) const;
+    void invert_board (const SquareGrid &board,
+                       SquareGrid &inverted_board) const;
+};
+
+// Declare functions that do not depend on an engine
+TrieNode* create_word_trie (const string &word_text);
+void insert_into_trie (TrieNode* root, string word);
+void delete_word_trie (TrieNode* node);
+void print_word_trie (TrieNode* node);
+void measure_trie (const TrieNode* node, long long &num_nodes,
+                   long long &num_edges, long long &num_bytes);
+long long measure_board (const SquareGrid &board);
+long long measure_move_cache (const MoveCache &cache);
+long long measure_move_list (const MoveList &moves);
+long long measure_search_pool (const SearchPool &pool);
+ostream &operator << (ostream &stream, SquareType type);
+vector <int> fill_rack (string letters);
+void fill_rack (const string &letters, vector <int> &rack);
+void add_sqr_to_move (int row, int col, char letter, Move &curr_move);
+Move invert_move (Move across_move);
+void reset_overlay (const BoardSnapshot &snapshot, BoardOverlay &overlay);
+string board_to_string (SquareGrid &board);
+void string_to_board (const string &letters, SquareGrid &board);
+int count_board_tiles (const SquareGrid &board);
+const char* play_error_message (PlayError error);
+string describe_play_check (const PlayCheck &check);
+
+#endif
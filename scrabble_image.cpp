@@ -0,0 +1,319 @@
+/**
+ * scrabble_image.cpp
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Reads, maps and writes lexicon images.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "scrabble_image.h"
+
+/**
+ * @param   file_name   the name of a file
+ * @return              true if the file starts with the lexicon image magic
+ */
+bool is_lexicon_image (string file_name)
+{
+    ifstream in_file;
+    in_file.open(file_name.c_str(), ifstream::in | ifstream::binary);
+
+    char magic[sizeof(IMAGE_MAGIC)] = {0};
+    in_file.read(magic, sizeof(magic));
+
+    return in_file.good() && memcmp(magic, IMAGE_MAGIC, sizeof(magic)) == 0;
+}
+
+/**
+ * Checks the header of a lexicon image and that every section is inside it.
+ *
+ * @param   file_name   the name of the image, for the error messages
+ * @param   image       the image to check
+ * @param   error       set to the reason if the image is not valid
+ * @return              true if the image is valid
+ */
+static bool check_lexicon_image (string file_name, const LexiconImage &image,
+                                 string &error)
+{
+    ImageHeader header;
+
+    if (image.size < sizeof(header))
+    {
+        error = file_name + " is not a lexicon image";
+        return false;
+    }
+
+    memcpy(&header, image.data.get(), sizeof(header));
+
+    if (memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 ||
+        header.version != IMAGE_VERSION)
+    {
+        error = file_name + " is not a version " + to_string(IMAGE_VERSION)
+                + " lexicon image";
+        return false;
+    }
+
+    // Check that every section is inside the file
+    uint64_t table_end = sizeof(header)
+                       + (uint64_t) header.num_sections * sizeof(ImageSection);
+
+    if (table_end > image.size)
+    {
+        error = file_name + " is truncated";
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.num_sections; i++)
+    {
+        ImageSection section;
+        memcpy(&section, image.data.get() + sizeof(header) + i * sizeof(section),
+               sizeof(section));
+
+        if (section.offset > image.size ||
+            section.size > image.size - section.offset ||
+            section.offset % IMAGE_ALIGNMENT != 0)
+        {
+            error = file_name + " is truncated";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Maps a lexicon image into memory and checks its header and sections. The
+ * file is mapped read-only and shared, so its pages are only read from disk
+ * (or from shared memory, for a file in /dev/shm) once for every process
+ * that maps it.
+ *
+ * @param   file_name   the name of the lexicon image file
+ * @param   image       the image to fill in. It is passed by reference since
+ *                      its data is replaced.
+ * @param   error       set to the reason if the image could not be read
+ * @return              true if the image was mapped and is valid
+ */
+bool read_lexicon_image (string file_name, LexiconImage &image, string &error)
+{
+    image = LexiconImage();
+    int fd = open(file_name.c_str(), O_RDONLY);
+    struct stat file_stat;
+
+    // Ensure file is open
+    if (fd == -1 || fstat(fd, &file_stat) != 0)
+    {
+        error = "Could not open " + file_name;
+
+        if (fd != -1)
+        {
+            close(fd);
+        }
+
+        return false;
+    }
+
+    uint64_t size = file_stat.st_size;
+    void* address = (size > 0) ?
+                    mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+
+    if (address == MAP_FAILED)
+    {
+        error = file_name + " is not a lexicon image";
+        return false;
+    }
+
+    // The mapping is removed along with the last copy of the image
+    image.data = shared_ptr <const char> ((const char*) address,
+                                         [size](const char* data)
+    {
+        munmap((void*) data, size);
+    });
+    image.size = size;
+    image.file_name = file_name;
+    image.device = file_stat.st_dev;
+    image.inode = file_stat.st_ino;
+
+    if (!check_lexicon_image(file_name, image, error))
+    {
+        image = LexiconImage();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Lays out a lexicon image. Each section starts at a multiple of
+ * IMAGE_ALIGNMENT bytes so that it can be used in place once loaded.
+ *
+ * @param   sections    the bytes of each section, keyed by ImageSectionId
+ * @return              the bytes of the image
+ */
+static string lay_out_lexicon_image (const map <uint32_t, string> &sections)
+{
+    ImageHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = IMAGE_VERSION;
+    header.num_sections = sections.size();
+
+    string bytes ((const char*) &header, sizeof(header));
+
+    // Lay out the sections one after the other after the table of sections
+    uint64_t offset = sizeof(header) + sections.size() * sizeof(ImageSection);
+    vector <uint64_t> offsets;
+
+    for (auto itr = sections.begin(); itr != sections.end(); itr++)
+    {
+        offset = (offset + IMAGE_ALIGNMENT - 1) / IMAGE_ALIGNMENT
+                 * IMAGE_ALIGNMENT;
+        offsets.push_back(offset);
+
+        ImageSection section;
+        memset(&section, 0, sizeof(section));
+        section.id = itr->first;
+        section.offset = offset;
+        section.size = itr->second.size();
+        bytes.append((const char*) &section, sizeof(section));
+
+        offset += itr->second.size();
+    }
+
+    // Add the sections with zeros for padding
+    int i = 0;
+
+    for (auto itr = sections.begin(); itr != sections.end(); itr++, i++)
+    {
+        bytes.resize(offsets[i], '\0');
+        bytes += itr->second;
+    }
+
+    return bytes;
+}
+
+/**
+ * Makes a lexicon image in memory, for a lexicon that was read from a text
+ * file. It is used in the same way as an image that was mapped from a file.
+ *
+ * @param   sections    the bytes of each section, keyed by ImageSectionId
+ * @param   image       the image to fill in
+ */
+void make_lexicon_image (const map <uint32_t, string> &sections,
+                         LexiconImage &image)
+{
+    string bytes = lay_out_lexicon_image(sections);
+
+    // new[] aligns the bytes for any type, so the sections can be used in
+    // place
+    char* data = new char [bytes.size()];
+    memcpy(data, bytes.data(), bytes.size());
+
+    image = LexiconImage();
+    image.data = shared_ptr <const char> (data, default_delete <const char[]>());
+    image.size = bytes.size();
+}
+
+/**
+ * @param   image   a lexicon image
+ * @return          false if the image was mapped from a file that has since
+ *                  been replaced by another image (or removed)
+ */
+bool is_lexicon_image_current (const LexiconImage &image)
+{
+    if (image.file_name == "")
+    {
+        return true;
+    }
+
+    struct stat file_stat;
+
+    return stat(image.file_name.c_str(), &file_stat) == 0 &&
+           (uint64_t) file_stat.st_dev == image.device &&
+           (uint64_t) file_stat.st_ino == image.inode;
+}
+
+/**
+ * @param   image   a lexicon image read by read_lexicon_image
+ * @param   id      the ImageSectionId of the section to find
+ * @param   size    set to the number of bytes in the section
+ * @return          a pointer to the start of the section or NULL if the
+ *                  image does not have the section
+ */
+const char* find_image_section (const LexiconImage &image, uint32_t id,
+                                uint64_t &size)
+{
+    size = 0;
+
+    if (image.data == NULL)
+    {
+        return NULL;
+    }
+
+    ImageHeader header;
+    memcpy(&header, image.data.get(), sizeof(header));
+
+    for (uint32_t i = 0; i < header.num_sections; i++)
+    {
+        ImageSection section;
+        memcpy(&section, image.data.get() + sizeof(header) + i * sizeof(section),
+               sizeof(section));
+
+        if (section.id == id)
+        {
+            size = section.size;
+            return image.data.get() + section.offset;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Writes a lexicon image. The image is written to a temporary file that is
+ * renamed to file_name once it is complete, so a process that maps file_name
+ * finds either the old image or the new one, and processes that have the old
+ * one mapped keep using it.
+ *
+ * @param   file_name   the name of the lexicon image file to create
+ * @param   sections    the bytes of each section, keyed by ImageSectionId
+ * @param   error       set to the reason if the image could not be written
+ * @return              true if the image was written
+ */
+bool write_lexicon_image (string file_name,
+                          const map <uint32_t, string> &sections,
+                          string &error)
+{
+    string temp_file_name = file_name + ".tmp" + to_string(getpid());
+    ofstream out_file;
+    out_file.open(temp_file_name.c_str(), ofstream::out | ofstream::binary);
+
+    // Ensure file is open
+    if (!out_file.is_open())
+    {
+        error = "Could not open " + temp_file_name;
+        return false;
+    }
+
+    string bytes = lay_out_lexicon_image(sections);
+    out_file.write(bytes.data(), bytes.size());
+    out_file.close();
+
+    if (!out_file.good() ||
+        rename(temp_file_name.c_str(), file_name.c_str()) != 0)
+    {
+        error = "Could not write " + file_name;
+        remove(temp_file_name.c_str());
+        return false;
+    }
+
+    return true;
+}
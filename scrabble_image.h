@@ -0,0 +1,85 @@
+/**
+ * scrabble_image.h
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Reads and writes lexicon images. A lexicon image is a binary file
+ *          made of a header, a table of sections, and the sections themselves.
+ *          It lets an engine load its lexicon without parsing a text file.
+ *
+ *          An image is mapped into memory read-only and the engine uses its
+ *          sections in place, so every process that maps the same file shares
+ *          its physical pages. An image is written to a temporary file that
+ *          is then renamed, so a new image can be published over an old one
+ *          while other processes still have the old one mapped.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#ifndef SCRABBLE_IMAGE_H
+#define SCRABBLE_IMAGE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+#define IMAGE_MAGIC "SCRBLEX"
+#define IMAGE_VERSION 3
+#define IMAGE_ALIGNMENT 8
+
+using namespace std;
+
+// The identifier of each section of a lexicon image
+enum ImageSectionId
+{
+    words_section = 1,      // Every word in sorted order, each ending in '\n'
+    alphagram_section = 2,  // The alphagram index (see scrabble_alphagram.h)
+    hooks_section = 3,      // The WordHooks of each letter and then of each
+                            // word in the order of the alphagram index
+    lexicon_section = 4,    // The FlatLexicon of the words longer than 2
+                            // letters (see scrabble_lexicon.h)
+    branch_section = 5      // The BranchSummary of each node of the
+                            // FlatLexicon, for word queries
+};
+
+struct ImageHeader
+{
+    char magic[8];          // IMAGE_MAGIC
+    uint32_t version;       // IMAGE_VERSION
+    uint32_t num_sections;  // The number of ImageSections after the header
+};
+
+struct ImageSection
+{
+    uint32_t id;            // An ImageSectionId
+    uint32_t reserved;
+    uint64_t offset;        // The offset of the section from the file's start
+    uint64_t size;          // The number of bytes in the section
+};
+
+// A lexicon image that has been mapped from a file or made in memory. Copies
+// share the same bytes, which are unmapped (or freed) with the last copy.
+struct LexiconImage
+{
+    shared_ptr <const char> data;   // NULL if there is no image
+    uint64_t size = 0;
+    string file_name;       // The file that was mapped ("" if made in memory)
+    uint64_t device = 0;    // The device and inode of the file, to find out
+    uint64_t inode = 0;     // whether another image has been published there
+};
+
+// Declare functions
+bool is_lexicon_image (string file_name);
+bool read_lexicon_image (string file_name, LexiconImage &image, string &error);
+void make_lexicon_image (const map <uint32_t, string> &sections,
+                         LexiconImage &image);
+bool is_lexicon_image_current (const LexiconImage &image);
+const char* find_image_section (const LexiconImage &image, uint32_t id,
+                                uint64_t &size);
+bool write_lexicon_image (string file_name,
+                          const map <uint32_t, string> &sections,
+                          string &error);
+
+#endif
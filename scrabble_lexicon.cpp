@@ -0,0 +1,612 @@
+/**
+ * scrabble_lexicon.cpp
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Implements the lexicon encodings declared in scrabble_lexicon.h.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#include <deque>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include "scrabble_lexicon.h"
+
+constexpr PointerLexicon::Node PointerLexicon::null_node;
+constexpr FlatLexicon::Node FlatLexicon::null_node;
+constexpr LoudsLexicon::Node LoudsLexicon::null_node;
+
+/**
+ * @param   position    a position in the bit string
+ * @return              the number of 1s before the position
+ */
+uint32_t LoudsLexicon::rank1 (uint64_t position) const
+{
+    uint64_t word = position / 64;
+    int offset = position % 64;
+
+    if (offset == 0)
+    {
+        return ranks[word];
+    }
+
+    return ranks[word] + __builtin_popcountll(bits[word] << (64 - offset));
+}
+
+/**
+ * Finds the position of a 0 of the bit string by a binary search over the
+ * number of 0s before each word, followed by a search within the word.
+ *
+ * @param   count   which 0 to find, starting at 1
+ * @return          the position of the count-th 0
+ */
+uint64_t LoudsLexicon::select0 (uint32_t count) const
+{
+    // Find the last word with fewer than count 0s before it
+    uint64_t low = 0, high = bits.size() - 1;
+
+    while (low < high)
+    {
+        uint64_t middle = (low + high + 1) / 2;
+
+        if (middle * 64 - ranks[middle] < count)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    uint64_t zeros = ~bits[low];
+
+    for (uint32_t i = low * 64 - ranks[low] + 1; i < count; i++)
+    {
+        zeros &= zeros - 1;
+    }
+
+    return low * 64 + __builtin_ctzll(zeros);
+}
+
+/**
+ * @param   lexicon     a LOUDS lexicon
+ * @param   position    the position of a node's first child bit
+ * @return              the number of 1s from the position to the next 0,
+ *                      which is the number of children of the node
+ */
+static int count_children (const LoudsLexicon &lexicon, uint64_t position)
+{
+    uint64_t word = position / 64;
+    int offset = position % 64;
+    uint64_t zeros = ~lexicon.bits[word] >> offset;
+
+    if (zeros != 0)
+    {
+        return __builtin_ctzll(zeros);
+    }
+
+    // A node has at most 26 children, so they end in the next word
+    return (64 - offset) + __builtin_ctzll(~lexicon.bits[word + 1]);
+}
+
+/**
+ * @param   node    a node of the lexicon
+ * @return          the letters of the node's children as a mask where bit 0
+ *                  is 'A' and bit 25 is 'Z'
+ */
+uint32_t LoudsLexicon::child_mask (Node node) const
+{
+    uint64_t start = select0(node + 1) + 1;
+    int num_children = count_children(*this, start);
+    uint32_t first = rank1(start);
+    uint32_t mask = 0;
+
+    for (int i = 0; i < num_children; i++)
+    {
+        mask |= 1 << (letters[first + i] - 'A');
+    }
+
+    return mask;
+}
+
+/**
+ * @param   node            a node of the lexicon
+ * @param   letter_index    the letter of the child, where 0 is 'A'
+ * @return                  the child or null_node if there is none
+ */
+LoudsLexicon::Node LoudsLexicon::child (Node node, int letter_index) const
+{
+    uint64_t start = select0(node + 1) + 1;
+    int num_children = count_children(*this, start);
+    uint32_t first = rank1(start);
+    char letter = 'A' + letter_index;
+
+    // The children are in alphabetical order
+    for (int i = 0; i < num_children; i++)
+    {
+        if (letters[first + i] == letter)
+        {
+            return first + i;
+        }
+        else if (letters[first + i] > letter)
+        {
+            break;
+        }
+    }
+
+    return null_node;
+}
+
+/**
+ * Numbers the nodes of a word graph in depth-first order. A node shared by
+ * several branches is only numbered once.
+ *
+ * @param   node    the node to number, along with its descendants
+ * @param   ids     the number of each node numbered so far
+ * @param   order   the nodes in the order they were numbered
+ */
+static void number_nodes (const TrieNode* node,
+                          unordered_map <const TrieNode*, uint32_t> &ids,
+                          vector <const TrieNode*> &order)
+{
+    if (ids.find(node) != ids.end())
+    {
+        return;
+    }
+
+    ids[node] = order.size();
+    order.push_back(node);
+
+    for (int i = 0; i < 26; i++)
+    {
+        if (node->letter_indexes[i] != -1)
+        {
+            number_nodes(node->children[node->letter_indexes[i]], ids, order);
+        }
+    }
+}
+
+/**
+ * Numbers the nodes of a word graph in breadth-first order, down to a depth.
+ * A node shared by several branches is numbered at its smallest depth.
+ *
+ * @param   root        the root of the word graph
+ * @param   max_depth   the depth of the deepest nodes to number
+ * @param   ids         the number of each node numbered so far
+ * @param   order       the nodes in the order they were numbered
+ * @param   below       set to the children of the deepest nodes numbered, in
+ *                      breadth-first order
+ */
+static void number_levels (const TrieNode* root, int max_depth,
+                           unordered_map <const TrieNode*, uint32_t> &ids,
+                           vector <const TrieNode*> &order,
+                           vector <const TrieNode*> &below)
+{
+    vector <const TrieNode*> level (1, root);
+    ids[root] = order.size();
+    order.push_back(root);
+
+    for (int depth = 0; depth < max_depth && !level.empty(); depth++)
+    {
+        vector <const TrieNode*> next_level;
+
+        for (unsigned int i = 0; i < level.size(); i++)
+        {
+            for (int j = 0; j < 26; j++)
+            {
+                int child_index = level[i]->letter_indexes[j];
+
+                if (child_index == -1)
+                {
+                    continue;
+                }
+
+                const TrieNode* child = level[i]->children[child_index];
+
+                if (ids.find(child) == ids.end())
+                {
+                    ids[child] = order.size();
+                    order.push_back(child);
+                    next_level.push_back(child);
+                }
+            }
+        }
+
+        level = next_level;
+    }
+
+    for (unsigned int i = 0; i < level.size(); i++)
+    {
+        for (int j = 0; j < 26; j++)
+        {
+            if (level[i]->letter_indexes[j] != -1)
+            {
+                below.push_back(
+                    level[i]->children[level[i]->letter_indexes[j]]);
+            }
+        }
+    }
+}
+
+/**
+ * Builds the lexicon section of a lexicon image from a word graph, with its
+ * nodes in the order of a layout. Shared nodes stay shared. The children of
+ * each node are stored in the order of the nodes, so the children of nodes
+ * that are close together are also close together.
+ *
+ * @param   root        the root of the word graph
+ * @param   layout      the order of the nodes
+ * @return              the bytes of the section, which read_lexicon_section
+ *                      reads as a FlatLexicon
+ */
+string build_lexicon_section (const TrieNode* root, NodeLayout layout)
+{
+    unordered_map <const TrieNode*, uint32_t> ids;
+    vector <const TrieNode*> order;
+    vector <const TrieNode*> below;
+
+    if (layout == depth_first_layout)
+    {
+        number_nodes(root, ids, order);
+    }
+    else
+    {
+        // A breadth-first layout is a hot levels layout with every level hot
+        int max_depth = (layout == breadth_first_layout) ? INT32_MAX :
+                                                           NUM_HOT_LEVELS - 1;
+        number_levels(root, max_depth, ids, order, below);
+
+        for (unsigned int i = 0; i < below.size(); i++)
+        {
+            number_nodes(below[i], ids, order);
+        }
+    }
+
+    vector <FlatNode> nodes (order.size());
+    vector <uint32_t> children;
+
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+        const TrieNode* node = order[i];
+        FlatNode &flat_node = nodes[i];
+        flat_node.child_mask = node->is_terminal_node ? FLAT_TERMINAL_BIT : 0;
+        flat_node.first_child = children.size();
+
+        for (int j = 0; j < 26; j++)
+        {
+            if (node->letter_indexes[j] != -1)
+            {
+                flat_node.child_mask |= 1 << j;
+                children.push_back(
+                    ids[node->children[node->letter_indexes[j]]]);
+            }
+        }
+    }
+
+    FlatLexicon lexicon;
+    lexicon.nodes = nodes.data();
+    lexicon.children = children.data();
+    lexicon.num_nodes = nodes.size();
+    lexicon.num_children = children.size();
+    lexicon.layout = layout;
+
+    return write_lexicon_section(lexicon);
+}
+
+/**
+ * Converts a flat lexicon into the lexicon section of a lexicon image.
+ *
+ * @param   lexicon     the lexicon to convert
+ * @return              the bytes of the section
+ */
+string write_lexicon_section (const FlatLexicon &lexicon)
+{
+    LexiconSectionHeader header;
+    header.num_nodes = lexicon.num_nodes;
+    header.num_children = lexicon.num_children;
+    header.layout = lexicon.layout;
+    header.reserved = 0;
+
+    string section ((const char*) &header, sizeof(header));
+    section.append((const char*) lexicon.nodes,
+                   lexicon.num_nodes * sizeof(FlatNode));
+    section.append((const char*) lexicon.children,
+                   lexicon.num_children * sizeof(uint32_t));
+
+    return section;
+}
+
+/**
+ * Reads a flat lexicon from the lexicon section of a lexicon image. The
+ * lexicon points into the section, which must start at a multiple of 8 bytes
+ * and be kept for as long as the lexicon is used.
+ *
+ * @param   section     the bytes of the section
+ * @param   size        the number of bytes in the section
+ * @param   lexicon     the lexicon to fill in
+ * @return              true if the section was valid
+ */
+bool read_lexicon_section (const char* section, uint64_t size,
+                           FlatLexicon &lexicon)
+{
+    LexiconSectionHeader header;
+
+    if (section == NULL || size < sizeof(header))
+    {
+        return false;
+    }
+
+    memcpy(&header, section, sizeof(header));
+
+    // Ensure the section is exactly the size given by its header
+    uint64_t expected_size = sizeof(header)
+                           + (uint64_t) header.num_nodes * sizeof(FlatNode)
+                           + (uint64_t) header.num_children * sizeof(uint32_t);
+
+    if (size != expected_size || header.num_nodes == 0 ||
+        header.layout > hot_levels_layout)
+    {
+        return false;
+    }
+
+    const char* data = section + sizeof(header);
+    lexicon.nodes = (const FlatNode*) data;
+    lexicon.num_nodes = header.num_nodes;
+    data += header.num_nodes * sizeof(FlatNode);
+
+    lexicon.children = (const uint32_t*) data;
+    lexicon.num_children = header.num_children;
+    lexicon.layout = (NodeLayout) header.layout;
+
+    // Ensure the children of every node are inside the lexicon
+    for (uint32_t i = 0; i < header.num_nodes; i++)
+    {
+        const FlatNode &node = lexicon.nodes[i];
+        uint32_t num_children =
+                    __builtin_popcount(node.child_mask & ~FLAT_TERMINAL_BIT);
+
+        if ((node.child_mask & ~FLAT_TERMINAL_BIT) >= (1u << 26) ||
+            (uint64_t) node.first_child + num_children > header.num_children)
+        {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < header.num_children; i++)
+    {
+        if (lexicon.children[i] >= header.num_nodes)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Summarizes the words below a node after summarizing its children. A node
+ * can have more than one parent, so it is summarized only once.
+ *
+ * @param   lexicon     the lexicon the node is in
+ * @param   node        the node to summarize
+ * @param   branches    the summary of each node
+ * @param   is_done     whether each node has been summarized
+ */
+static void summarize_branch (const FlatLexicon &lexicon, uint32_t node,
+                              vector <BranchSummary> &branches,
+                              vector <bool> &is_done)
+{
+    if (is_done[node])
+    {
+        return;
+    }
+
+    BranchSummary summary = {0, 0, 0};
+
+    for (uint32_t mask = lexicon.child_mask(node); mask != 0; mask &= mask - 1)
+    {
+        int letter_index = __builtin_ctz(mask);
+        uint32_t child = lexicon.child(node, letter_index);
+        summarize_branch(lexicon, child, branches, is_done);
+
+        const BranchSummary &below = branches[child];
+        summary.letters |= (1u << letter_index) | below.letters;
+        summary.last_letters |= below.last_letters;
+
+        if (lexicon.is_terminal(child))
+        {
+            summary.last_letters |= 1u << letter_index;
+        }
+
+        summary.max_length = max(summary.max_length, below.max_length + 1);
+    }
+
+    branches[node] = summary;
+    is_done[node] = true;
+}
+
+/**
+ * Builds the branch section of a lexicon image, which has the BranchSummary
+ * of each node of the lexicon in the order of its nodes.
+ *
+ * @param   lexicon     the lexicon to summarize
+ * @return              the bytes of the section
+ */
+string build_branch_section (const FlatLexicon &lexicon)
+{
+    vector <BranchSummary> branches (lexicon.num_nodes);
+    vector <bool> is_done (lexicon.num_nodes, false);
+
+    summarize_branch(lexicon, lexicon.root(), branches, is_done);
+
+    return string((const char*) branches.data(),
+                  branches.size() * sizeof(BranchSummary));
+}
+
+/**
+ * Reads the BranchSummaries of a lexicon from the branch section of a lexicon
+ * image. The summaries point into the section.
+ *
+ * @param   section     the bytes of the section
+ * @param   size        the number of bytes in the section
+ * @param   lexicon     the lexicon that was summarized
+ * @param   branches    set to the summary of each node of the lexicon
+ * @return              true if the section had a summary of every node
+ */
+bool read_branch_section (const char* section, uint64_t size,
+                          const FlatLexicon &lexicon,
+                          const BranchSummary* &branches)
+{
+    if (section == NULL ||
+        size != (uint64_t) lexicon.num_nodes * sizeof(BranchSummary))
+    {
+        return false;
+    }
+
+    branches = (const BranchSummary*) section;
+    return true;
+}
+
+/**
+ * @param   layout  a node layout
+ * @return          the name of the layout, as given to parse_layout_name
+ */
+const char* get_layout_name (NodeLayout layout)
+{
+    switch (layout)
+    {
+        case depth_first_layout:    return "dfs";
+        case breadth_first_layout:  return "bfs";
+        case hot_levels_layout:     return "hot";
+    }
+
+    return "unknown";
+}
+
+/**
+ * @param   name    the name of a layout ("dfs", "bfs" or "hot")
+ * @param   layout  set to the layout with the name
+ * @return          true if the name is the name of a layout
+ */
+bool parse_layout_name (string name, NodeLayout &layout)
+{
+    for (int i = depth_first_layout; i <= hot_levels_layout; i++)
+    {
+        if (name == get_layout_name((NodeLayout) i))
+        {
+            layout = (NodeLayout) i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Adds a bit to the end of a bit string.
+ *
+ * @param   bits        the bit string
+ * @param   num_bits    the number of bits in the string, which is incremented
+ * @param   bit         the bit to add
+ */
+static void push_bit (vector <uint64_t> &bits, uint64_t &num_bits, bool bit)
+{
+    if (num_bits % 64 == 0)
+    {
+        bits.push_back(0);
+    }
+
+    bits.back() |= (uint64_t) bit << (num_bits % 64);
+    num_bits++;
+}
+
+/**
+ * Builds a LOUDS lexicon of a word graph. The encoding is of a tree, so the
+ * nodes shared by the graph are stored once for each of their parents.
+ *
+ * @param   root        the root of the word graph
+ * @param   lexicon     the lexicon to build
+ */
+void build_louds_lexicon (const TrieNode* root, LoudsLexicon &lexicon)
+{
+    uint64_t num_bits = 0;
+    lexicon.bits.clear();
+    lexicon.terminals.clear();
+    lexicon.letters.clear();
+
+    // The initial "10" is the root's own 1
+    push_bit(lexicon.bits, num_bits, true);
+    push_bit(lexicon.bits, num_bits, false);
+
+    deque <const TrieNode*> queue (1, root);
+
+    while (!queue.empty())
+    {
+        const TrieNode* node = queue.front();
+        queue.pop_front();
+
+        uint32_t id = lexicon.letters.size();
+        lexicon.letters.push_back(node->letter);
+
+        if (id % 64 == 0)
+        {
+            lexicon.terminals.push_back(0);
+        }
+
+        lexicon.terminals.back() |=
+                            (uint64_t) node->is_terminal_node << (id % 64);
+
+        for (int i = 0; i < 26; i++)
+        {
+            if (node->letter_indexes[i] != -1)
+            {
+                push_bit(lexicon.bits, num_bits, true);
+                queue.push_back(node->children[node->letter_indexes[i]]);
+            }
+        }
+
+        push_bit(lexicon.bits, num_bits, false);
+    }
+
+    lexicon.num_nodes = lexicon.letters.size();
+
+    // An extra word lets count_children look past the last node's bits
+    lexicon.bits.push_back(0);
+    lexicon.ranks.resize(lexicon.bits.size());
+    uint32_t num_ones = 0;
+
+    for (unsigned int i = 0; i < lexicon.bits.size(); i++)
+    {
+        lexicon.ranks[i] = num_ones;
+        num_ones += __builtin_popcountll(lexicon.bits[i]);
+    }
+
+    lexicon.bits.shrink_to_fit();
+    lexicon.terminals.shrink_to_fit();
+    lexicon.letters.shrink_to_fit();
+}
+
+/**
+ * @param   lexicon     a flat lexicon
+ * @return              the number of bytes used by the lexicon
+ */
+long long measure_flat_lexicon (const FlatLexicon &lexicon)
+{
+    return (long long) lexicon.num_nodes * sizeof(FlatNode)
+         + (long long) lexicon.num_children * sizeof(uint32_t);
+}
+
+/**
+ * @param   lexicon     a LOUDS lexicon
+ * @return              the number of bytes used by the lexicon
+ */
+long long measure_louds_lexicon (const LoudsLexicon &lexicon)
+{
+    return lexicon.bits.capacity() * sizeof(uint64_t)
+         + lexicon.ranks.capacity() * sizeof(uint32_t)
+         + lexicon.terminals.capacity() * sizeof(uint64_t)
+         + lexicon.letters.capacity();
+}
@@ -0,0 +1,230 @@
+/**
+ * scrabble_lexicon.h
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: The encodings of the lexicon's word graph. Each encoding has the
+ *          same traversal functions, so that code that walks a lexicon can be
+ *          written once as a template and run on any of them:
+ *
+ *              Node root () const
+ *              bool is_terminal (Node node) const
+ *              uint32_t child_mask (Node node) const   bit i = a child with
+ *                                                      the letter 'A' + i
+ *              Node child (Node node, int letter_index) const
+ *                                                      null_node if there is
+ *                                                      no such child
+ *
+ *          PointerLexicon walks the TrieNodes that the word graph is built
+ *          from. FlatLexicon stores the nodes of the word graph in one array
+ *          with the children of each node in another. It is the encoding the
+ *          engine walks and is used in place in the lexicon image.
+ *          LoudsLexicon stores the shape of the (unminimized) trie as a bit
+ *          string with 2 bits per node (level-order unary degree sequence),
+ *          which is the smallest but the slowest to walk.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#ifndef SCRABBLE_LEXICON_H
+#define SCRABBLE_LEXICON_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#define NO_LEXICON_NODE 0xFFFFFFFF
+#define FLAT_TERMINAL_BIT (1u << 31)   // Set in the child_mask of a FlatNode
+                                        // that ends a word
+#define NUM_HOT_LEVELS 3    // The levels of the graph that hot_levels_layout
+                            // puts first
+
+using namespace std;
+
+// A node of the word graph. The words are stored as in a trie, except that
+// words with the same endings share the nodes of their endings, so a node can
+// have more than one parent.
+struct TrieNode
+{
+    char letter; // Special value: "*" if root node
+    bool is_terminal_node;
+
+    vector <TrieNode*> children;
+
+    // Stores the index of each letter of each children node
+    // Ex. If a child has a letter 'C' at children [1],
+    //     then letters_present['C'-'A'] == letters_present[2] == 1
+    vector <int> letter_indexes {vector <int> (26, -1)};
+};
+
+// The order of the nodes of a FlatLexicon. The values are stored in lexicon
+// images, so new values must be added at the end.
+enum NodeLayout
+{
+    depth_first_layout,     // Each node is followed by its descendants
+    breadth_first_layout,   // The nodes are in order of their depth
+    hot_levels_layout       // The first NUM_HOT_LEVELS levels, which are
+                            // visited by nearly every walk, are together in
+                            // breadth-first order. Each subtree below them
+                            // then follows in depth-first order.
+};
+
+// Walks the TrieNodes of a word graph
+struct PointerLexicon
+{
+    typedef const TrieNode* Node;
+    static constexpr Node null_node = NULL;
+
+    const TrieNode* root_node;
+
+    Node root () const
+    {
+        return root_node;
+    }
+
+    bool is_terminal (Node node) const
+    {
+        return node->is_terminal_node;
+    }
+
+    uint32_t child_mask (Node node) const
+    {
+        uint32_t mask = 0;
+
+        for (unsigned int i = 0; i < node->children.size(); i++)
+        {
+            mask |= 1 << (node->children[i]->letter - 'A');
+        }
+
+        return mask;
+    }
+
+    Node child (Node node, int letter_index) const
+    {
+        int child_index = node->letter_indexes[letter_index];
+        return (child_index == -1) ? null_node : node->children[child_index];
+    }
+};
+
+struct FlatNode
+{
+    uint32_t child_mask;    // Bit i = a child with the letter 'A' + i, and
+                            // FLAT_TERMINAL_BIT if the node ends a word
+    uint32_t first_child;   // The index in children of the node's first child
+};
+
+// The word graph as arrays. The children of a node are stored in alphabetical
+// order from children[first_child], so the child with a letter is found by
+// counting the bits of child_mask below the letter. The arrays are those of a
+// lexicon section (see read_lexicon_section), so they are not copied from a
+// lexicon image.
+struct FlatLexicon
+{
+    typedef uint32_t Node;
+    static constexpr Node null_node = NO_LEXICON_NODE;
+
+    const FlatNode* nodes = NULL;       // nodes[0] is the root
+    const uint32_t* children = NULL;    // The index in nodes of each child
+    uint32_t num_nodes = 0;
+    uint32_t num_children = 0;
+    NodeLayout layout = hot_levels_layout;
+
+    Node root () const
+    {
+        return 0;
+    }
+
+    bool is_terminal (Node node) const
+    {
+        return (nodes[node].child_mask & FLAT_TERMINAL_BIT) != 0;
+    }
+
+    uint32_t child_mask (Node node) const
+    {
+        return nodes[node].child_mask & ~FLAT_TERMINAL_BIT;
+    }
+
+    Node child (Node node, int letter_index) const
+    {
+        uint32_t mask = nodes[node].child_mask;
+
+        if (((mask >> letter_index) & 1) == 0)
+        {
+            return null_node;
+        }
+
+        uint32_t below = mask & ((1u << letter_index) - 1);
+        return children[nodes[node].first_child + __builtin_popcount(below)];
+    }
+};
+
+// The trie in level order. The nodes are numbered in level order from the
+// root (0), and each node is written to the bit string as one 1 for each
+// child followed by a 0, after an initial "10" for the root. The children of
+// node v are then the 1s after the (v + 1)th 0, and the child at bit p is
+// node (number of 1s before p).
+struct LoudsLexicon
+{
+    typedef uint32_t Node;
+    static constexpr Node null_node = NO_LEXICON_NODE;
+
+    vector <uint64_t> bits;         // The level-order unary degree sequence
+    vector <uint32_t> ranks;        // The number of 1s before each word of bits
+    vector <uint64_t> terminals;    // Bit v = node v ends a word
+    vector <char> letters;          // The letter of each node ('*' for root)
+    uint32_t num_nodes;
+
+    Node root () const
+    {
+        return 0;
+    }
+
+    bool is_terminal (Node node) const
+    {
+        return (terminals[node / 64] >> (node % 64)) & 1;
+    }
+
+    uint32_t child_mask (Node node) const;
+    Node child (Node node, int letter_index) const;
+
+    uint32_t rank1 (uint64_t position) const;
+    uint64_t select0 (uint32_t count) const;
+};
+
+// The start of the lexicon section of a lexicon image, which is followed by
+// the nodes and the children of a FlatLexicon
+struct LexiconSectionHeader
+{
+    uint32_t num_nodes;
+    uint32_t num_children;
+    uint32_t layout;        // A NodeLayout
+    uint32_t reserved;
+};
+
+// What the words below a node of a FlatLexicon have in common, so that a
+// word query can leave a branch that has no word it could match. The letters
+// are those after the node (bit i = the letter 'A' + i).
+struct BranchSummary
+{
+    uint32_t letters;       // The letters in any word below the node
+    uint32_t last_letters;  // The letters that end any word below the node
+    uint32_t max_length;    // The most letters after the node in any word
+};
+
+// Declare functions
+string build_lexicon_section (const TrieNode* root, NodeLayout layout);
+string write_lexicon_section (const FlatLexicon &lexicon);
+bool read_lexicon_section (const char* section, uint64_t size,
+                           FlatLexicon &lexicon);
+string build_branch_section (const FlatLexicon &lexicon);
+bool read_branch_section (const char* section, uint64_t size,
+                          const FlatLexicon &lexicon,
+                          const BranchSummary* &branches);
+const char* get_layout_name (NodeLayout layout);
+bool parse_layout_name (string name, NodeLayout &layout);
+void build_louds_lexicon (const TrieNode* root, LoudsLexicon &lexicon);
+long long measure_flat_lexicon (const FlatLexicon &lexicon);
+long long measure_louds_lexicon (const LoudsLexicon &lexicon);
+
+#endif
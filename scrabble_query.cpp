@@ -0,0 +1,589 @@
+/**
+ * scrabble_query.cpp
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Implements the word queries declared in scrabble_query.h.
+ *
+ *          The trie is walked in alphabetical order, so the words are found in
+ *          alphabetical order without being stored. A pattern is matched by
+ *          keeping the set of pattern positions that the letters so far can
+ *          reach, so a branch of the trie is left as soon as no position can
+ *          be reached. A rack is matched by taking a tile out of the rack for
+ *          each letter (a blank only if the letter is not in the rack), so a
+ *          branch is left as soon as the rack runs out. A branch is also left
+ *          when the summary of the words below it (see BranchSummary) shows
+ *          that none of them can have the letters that are still needed, end
+ *          as the pattern ends, or be long enough.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#include <cctype>
+#include <algorithm>
+#include <unordered_set>
+#include "scrabble_query.h"
+#include "scrabble_trace.h"
+
+// The state of one query as the trie is walked
+struct QuerySearch
+{
+    const Engine* engine;
+    WordCallback callback;
+    string pattern;
+    bool match_any;                 // The pattern is "*", so any word matches
+    bool use_rack;
+    bool use_all_tiles;
+    int rack [27];                  // The tiles left in the rack ([26] = blanks)
+    int num_rack_tiles;             // The number of tiles left in the rack
+    bool is_excluded [26];
+    int required [26];              // The required letters not yet in the word
+    int num_required;
+    int min_length;
+    int max_length;
+    size_t limit;
+    size_t num_found;
+    bool is_stopped;
+    string word;                    // The letters of the current branch
+    const BranchSummary* branches;  // The engine's summary of each node
+    bool use_branches;              // The summaries can leave out branches
+    uint32_t required_letters;      // The letters that required has left
+    uint32_t pattern_letters [MAX_PATTERN_LENGTH + 1];
+                                    // The letters at or after each position
+    uint32_t last_letters;          // The letters that a match can end with
+    bool two_letter_words [26];     // The two-letter words that start with
+                                    // the first letter of the branch
+};
+
+/**
+ * Adds the pattern positions that can be reached without a letter, which are
+ * the positions right after a '*'.
+ *
+ * @param   pattern     the pattern of the query
+ * @param   positions   a set of pattern positions as a bit mask
+ * @return              the positions along with those after each '*'
+ */
+static uint64_t skip_stars (const string &pattern, uint64_t positions)
+{
+    for (unsigned int i = 0; i < pattern.length(); i++)
+    {
+        if ((positions >> i & 1) && pattern[i] == '*')
+        {
+            positions |= (uint64_t) 1 << (i + 1);
+        }
+    }
+
+    return positions;
+}
+
+/**
+ * Finds the pattern positions that can be reached by adding a letter.
+ *
+ * @param   pattern     the pattern of the query
+ * @param   positions   the positions reached before the letter as a bit mask
+ * @param   letter      the uppercase letter added
+ * @return              the positions reached after the letter
+ */
+static uint64_t match_letter (const string &pattern, uint64_t positions,
+                              char letter)
+{
+    uint64_t next_positions = 0;
+
+    for (unsigned int i = 0; i < pattern.length(); i++)
+    {
+        if (!(positions >> i & 1))
+        {
+            continue;
+        }
+
+        if (pattern[i] == '*')
+        {
+            next_positions |= (uint64_t) 1 << i;
+        }
+        else if (pattern[i] == '?' || pattern[i] == letter)
+        {
+            next_positions |= (uint64_t) 1 << (i + 1);
+        }
+    }
+
+    return skip_stars(pattern, next_positions);
+}
+
+/**
+ * Finds out whether the words below a trie node can meet the query, from the
+ * node's branch summary. Each letter of the pattern after a position must be
+ * matched, and a position further along has fewer letters after it, so the
+ * letters after the furthest position reached are in every match.
+ *
+ * @param   search      the state of the query
+ * @param   node        the node of a branch longer than one letter
+ * @param   positions   the pattern positions reached by the branch
+ * @return              false if no word below the node can meet the query
+ */
+static bool can_branch_match (const QuerySearch &search, uint32_t node,
+                              uint64_t positions)
+{
+    const BranchSummary &branch = search.branches[node];
+    int length = search.word.length() + branch.max_length;
+    uint32_t letters = search.required_letters;
+
+    if (!search.match_any)
+    {
+        letters |= search.pattern_letters[63 - __builtin_clzll(positions)];
+
+        if ((branch.last_letters & search.last_letters) == 0)
+        {
+            return false;
+        }
+    }
+
+    return (letters & ~branch.letters) == 0 &&
+           length >= search.min_length &&
+           (!search.use_all_tiles ||
+            (int) branch.max_length >= search.num_rack_tiles);
+}
+
+/**
+ * Goes through the children of a trie node in alphabetical order and passes
+ * every word that meets the query to the callback.
+ *
+ * Two-letter words are not in the trie, so a word whose second letter has no
+ * node is still found if it is in the lexicon.
+ *
+ * @param   search      the state of the query
+ * @param   node        the node of the current branch (NO_LEXICON_NODE if
+ *                      the branch is a two-letter word with no longer words
+ *                      after it)
+ * @param   positions   the pattern positions reached by the current branch
+ */
+static void visit_node (QuerySearch &search, uint32_t node,
+                        uint64_t positions)
+{
+    const FlatLexicon &lexicon = search.engine->get_lexicon();
+    int depth = search.word.length();
+    uint64_t end_position = (uint64_t) 1 << search.pattern.length();
+
+    for (int letter_index = 0; letter_index < 26; letter_index++)
+    {
+        char letter = 'A' + letter_index;
+
+        uint32_t child = (node == NO_LEXICON_NODE) ? NO_LEXICON_NODE :
+                         lexicon.child(node, letter_index);
+
+        bool is_two_letter_word = (depth == 1) &&
+                                  search.two_letter_words[letter_index];
+
+        if ((child == NO_LEXICON_NODE && !is_two_letter_word) ||
+            search.is_excluded[letter_index] ||
+            (search.use_rack && search.rack[letter_index] == 0 &&
+             search.rack[26] == 0))
+        {
+            continue;
+        }
+
+        uint64_t next_positions = search.match_any ? positions :
+                                  match_letter(search.pattern, positions,
+                                               letter);
+
+        if (next_positions == 0)
+        {
+            continue;
+        }
+
+        // Take the tile out of the rack, using a blank only if needed
+        int tile_index = letter_index;
+
+        if (search.use_rack)
+        {
+            if (search.rack[letter_index] == 0)
+            {
+                tile_index = 26;
+            }
+
+            search.rack[tile_index]--;
+            search.num_rack_tiles--;
+        }
+
+        bool was_required = search.required[letter_index] > 0;
+
+        if (was_required)
+        {
+            search.required[letter_index]--;
+            search.num_required--;
+
+            if (search.required[letter_index] == 0)
+            {
+                search.required_letters &= ~(1u << letter_index);
+            }
+        }
+
+        search.word += (tile_index == 26) ? (char) tolower(letter) : letter;
+
+        bool is_terminal = (child != NO_LEXICON_NODE &&
+                            lexicon.is_terminal(child)) ||
+                           is_two_letter_word;
+
+        if (is_terminal && (next_positions & end_position) &&
+            depth + 1 >= search.min_length &&
+            search.num_required == 0 &&
+            (!search.use_all_tiles || search.num_rack_tiles == 0))
+        {
+            search.num_found++;
+
+            if (!search.callback(search.word) ||
+                search.num_found == search.limit)
+            {
+                search.is_stopped = true;
+            }
+        }
+
+        // The two-letter words after a branch of one letter are not in its
+        // branch summary, so only longer branches are checked against theirs
+        if (!search.is_stopped && child != NO_LEXICON_NODE &&
+            depth + 1 < search.max_length &&
+            (!search.use_rack || search.num_rack_tiles > 0) &&
+            (depth == 0 || !search.use_branches ||
+             can_branch_match(search, child, next_positions)))
+        {
+            if (depth == 0)
+            {
+                for (int i = 0; i < 26; i++)
+                {
+                    search.two_letter_words[i] = search.engine->is_word(
+                        string(1, letter) + (char) ('A' + i));
+                }
+            }
+
+            visit_node(search, child, next_positions);
+        }
+
+        // Put everything back for the next letter
+        search.word.erase(depth);
+
+        if (was_required)
+        {
+            search.required[letter_index]++;
+            search.num_required++;
+            search.required_letters |= 1u << letter_index;
+        }
+
+        if (search.use_rack)
+        {
+            search.rack[tile_index]++;
+            search.num_rack_tiles++;
+        }
+
+        if (search.is_stopped)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * Fills in a query from the command line.
+ *
+ * @param   type        "pattern", "anagram" or "subanagram"
+ * @param   letters     the pattern or the rack, in uppercase or lowercase
+ * @param   query       the query to fill in
+ * @return              true if the type and letters were valid
+ */
+bool parse_word_query (string type, string letters, WordQuery &query)
+{
+    for (unsigned int i = 0; i < letters.length(); i++)
+    {
+        letters[i] = toupper(letters[i]);
+
+        if (!isupper(letters[i]) && letters[i] != '?' &&
+            (letters[i] != '*' || type != "pattern"))
+        {
+            return false;
+        }
+    }
+
+    if (type == "pattern" && letters != "" &&
+        letters.length() <= MAX_PATTERN_LENGTH)
+    {
+        query.pattern = letters;
+    }
+    else if ((type == "anagram" || type == "subanagram") && letters != "")
+    {
+        query.rack = letters;
+        query.use_all_tiles = (type == "anagram");
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Finds the words of the lexicon that meet a query.
+ *
+ * @param   engine      the engine whose lexicon is searched
+ * @param   query       the conditions that the words must meet
+ * @param   callback    called with each word found. Returns false to stop.
+ * @return              the number of words found
+ */
+size_t find_words (const Engine &engine, const WordQuery &query,
+                   WordCallback callback)
+{
+    TraceSpan span ("find_words", "query");
+
+    if (query.pattern.length() > MAX_PATTERN_LENGTH)
+    {
+        return 0;
+    }
+
+    QuerySearch search;
+    search.engine = &engine;
+    search.callback = callback;
+    search.pattern = query.pattern;
+    search.match_any = (query.pattern == "*");
+    search.use_rack = (query.rack != "");
+    search.use_all_tiles = search.use_rack && query.use_all_tiles;
+    search.num_rack_tiles = 0;
+    search.num_required = 0;
+    search.limit = query.limit;
+    search.num_found = 0;
+    search.is_stopped = false;
+    search.branches = engine.get_branches();
+    search.required_letters = 0;
+
+    for (int i = 0; i < 27; i++)
+    {
+        search.rack[i] = 0;
+    }
+
+    for (int i = 0; i < 26; i++)
+    {
+        search.is_excluded[i] = false;
+        search.required[i] = 0;
+    }
+
+    for (unsigned int i = 0; i < query.rack.length(); i++)
+    {
+        if (isupper(query.rack[i]))
+        {
+            search.rack[query.rack[i] - 'A']++;
+            search.num_rack_tiles++;
+        }
+        else if (query.rack[i] == '?')
+        {
+            search.rack[26]++;
+            search.num_rack_tiles++;
+        }
+    }
+
+    for (unsigned int i = 0; i < query.excluded.length(); i++)
+    {
+        if (isupper(query.excluded[i]))
+        {
+            search.is_excluded[query.excluded[i] - 'A'] = true;
+        }
+    }
+
+    for (unsigned int i = 0; i < query.required.length(); i++)
+    {
+        if (isupper(query.required[i]))
+        {
+            search.required[query.required[i] - 'A']++;
+            search.num_required++;
+            search.required_letters |= 1u << (query.required[i] - 'A');
+        }
+    }
+
+    // The letters that a match must have after each pattern position, and
+    // the letters it can end with
+    uint32_t letters = 0;
+    search.pattern_letters[search.pattern.length()] = 0;
+
+    for (int i = (int) search.pattern.length() - 1; i >= 0; i--)
+    {
+        if (isupper(search.pattern[i]))
+        {
+            letters |= 1u << (search.pattern[i] - 'A');
+        }
+
+        search.pattern_letters[i] = letters;
+    }
+
+    char last = search.pattern.empty() ? '*' :
+                search.pattern[search.pattern.length() - 1];
+    search.last_letters = isupper(last) ? 1u << (last - 'A') :
+                                          (1u << 26) - 1;
+
+    // Otherwise every branch has a word that meets the query, which is not
+    // worth checking for
+    search.use_branches = letters != 0 || search.required_letters != 0 ||
+                          query.min_length > 3 || search.use_all_tiles;
+
+    uint64_t start_positions = skip_stars(search.pattern, 1);
+    int max_length = query.max_length;
+
+    if (search.use_rack && search.num_rack_tiles < max_length)
+    {
+        max_length = search.num_rack_tiles;
+    }
+
+    if (query.order == alphabetical_order)
+    {
+        search.min_length = query.min_length;
+        search.max_length = max_length;
+        visit_node(search, engine.get_lexicon().root(), start_positions);
+    }
+    else
+    {
+        // Walk the trie once for each length, from the longest to the shortest
+        for (int length = max_length;
+             length >= query.min_length && !search.is_stopped; length--)
+        {
+            search.min_length = length;
+            search.max_length = length;
+            visit_node(search, engine.get_lexicon().root(), start_positions);
+        }
+    }
+
+    return search.num_found;
+}
+
+/**
+ * Marks the letters of a word that must be made with blanks. The letters are
+ * taken from the rack from left to right, so the last copies of a letter that
+ * the rack runs out of are the blanks.
+ *
+ * @param   word    an uppercase word made from the rack
+ * @param   rack    the number of each letter in the rack
+ * @return          the word with the blank letters in lowercase
+ */
+static string mark_blanks (string word, const int rack [26])
+{
+    int used [26] = {0};
+
+    for (unsigned int i = 0; i < word.length(); i++)
+    {
+        int letter_index = word[i] - 'A';
+
+        if (letter_index >= 0 && letter_index < 26 &&
+            ++used[letter_index] > rack[letter_index])
+        {
+            word[i] = tolower(word[i]);
+        }
+    }
+
+    return word;
+}
+
+/**
+ * Finds the words that use every tile of a rack by looking up the rack's
+ * alphagram. Each blank is tried as every letter, so a rack with one blank
+ * takes 26 lookups and a rack with two blanks takes 351 (one per pair of
+ * letters).
+ *
+ * @param   engine  the engine whose lexicon is searched
+ * @param   rack    uppercase letters with up to MAX_INDEX_BLANKS '?' blanks
+ * @param   words   the words found are added to the end, in order of
+ *                  alphagram, with the blank letters in lowercase
+ * @return          the number of words found (0 if the rack is not valid)
+ */
+size_t find_anagrams (const Engine &engine, string rack,
+                      vector <string> &words)
+{
+    const AlphagramIndex &index = engine.get_alphagram_index();
+    int rack_counts [26] = {0};
+    string letters;
+    int num_blanks = 0;
+
+    for (unsigned int i = 0; i < rack.length(); i++)
+    {
+        if (isupper(rack[i]))
+        {
+            rack_counts[rack[i] - 'A']++;
+            letters += rack[i];
+        }
+        else if (rack[i] == '?')
+        {
+            num_blanks++;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    if (num_blanks > MAX_INDEX_BLANKS)
+    {
+        return 0;
+    }
+
+    size_t first_word = words.size();
+
+    // Try every letter for the first blank (if any) and every letter from
+    // there on for the second blank (if any), so each alphagram is tried once
+    for (char first = 'A'; first <= (num_blanks >= 1 ? 'Z' : 'A'); first++)
+    {
+        for (char second = first;
+             second <= (num_blanks == 2 ? 'Z' : first); second++)
+        {
+            string blank_letters = string(1, first) + second;
+            find_alphagram_words(index, make_alphagram(
+                letters + blank_letters.substr(0, num_blanks)), words);
+        }
+    }
+
+    for (size_t i = first_word; i < words.size(); i++)
+    {
+        words[i] = mark_blanks(words[i], rack_counts);
+    }
+
+    return words.size() - first_word;
+}
+
+/**
+ * Finds the bingos of a rack: the words that use every tile of the rack, and
+ * the words that use every tile of the rack along with one letter already on
+ * the board.
+ *
+ * @param   engine  the engine whose lexicon is searched
+ * @param   rack    uppercase letters with up to MAX_INDEX_BLANKS '?' blanks
+ * @param   words   the words found are added to the end, with the blank
+ *                  letters in lowercase, starting with the words that only
+ *                  use the rack
+ * @return          the number of words found (0 if the rack is not valid)
+ */
+size_t find_bingos (const Engine &engine, string rack, vector <string> &words)
+{
+    if (rack.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZ?") != string::npos ||
+        count(rack.begin(), rack.end(), '?') > MAX_INDEX_BLANKS)
+    {
+        return 0;
+    }
+
+    size_t first_word = words.size();
+    find_anagrams(engine, rack, words);
+
+    // With blanks, the same word can be made through different board letters
+    unordered_set <string> found_words;
+    vector <string> through_words;
+
+    for (char letter = 'A'; letter <= 'Z'; letter++)
+    {
+        through_words.clear();
+        find_anagrams(engine, rack + letter, through_words);
+
+        for (unsigned int i = 0; i < through_words.size(); i++)
+        {
+            string word = through_words[i];
+            transform(word.begin(), word.end(), word.begin(), ::toupper);
+
+            if (found_words.insert(word).second)
+            {
+                words.push_back(through_words[i]);
+            }
+        }
+    }
+
+    return words.size() - first_word;
+}
@@ -0,0 +1,65 @@
+/**
+ * scrabble_query.h
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Finds the words of an engine's lexicon that match a pattern, that
+ *          can be made from a rack (anagrams and subanagrams, with blanks) or
+ *          that contain or leave out certain letters. The words are found by
+ *          walking the engine's trie and are passed to a callback as soon as
+ *          they are found.
+ *
+ *          The anagrams and bingos of a rack are looked up directly in the
+ *          engine's alphagram index instead.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#ifndef SCRABBLE_QUERY_H
+#define SCRABBLE_QUERY_H
+
+#include <string>
+#include <functional>
+#include "scrabble_engine.h"
+
+#define MAX_PATTERN_LENGTH 63   // Pattern positions are kept in a 64 bit mask
+#define MAX_INDEX_BLANKS 2      // The most blanks in an alphagram lookup
+
+using namespace std;
+
+enum QueryOrder
+{
+    alphabetical_order,
+    longest_first
+};
+
+// The words to find. Every condition must be met.
+struct WordQuery
+{
+    // '?' = any one letter and '*' = any number of letters (including none)
+    string pattern {"*"};
+
+    // If not empty, the words must be made from these tiles ('?' = blank)
+    string rack;
+    bool use_all_tiles {false};     // Only anagrams that use the whole rack
+
+    string required;    // Letters that every word must contain
+    string excluded;    // Letters that no word may contain
+    int min_length {2};
+    int max_length {NUM_BOARD_COLS};
+    size_t limit {0};   // The most words to find (0 = no limit)
+    QueryOrder order {alphabetical_order};
+};
+
+// Called with each word found, where a lowercase letter is made with a blank.
+// Return false to stop the query.
+typedef function <bool (const string &word)> WordCallback;
+
+bool parse_word_query (string type, string letters, WordQuery &query);
+size_t find_words (const Engine &engine, const WordQuery &query,
+                   WordCallback callback);
+size_t find_anagrams (const Engine &engine, string rack,
+                      vector <string> &words);
+size_t find_bingos (const Engine &engine, string rack, vector <string> &words);
+
+#endif
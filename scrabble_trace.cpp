@@ -0,0 +1,164 @@
+/**
+ * scrabble_trace.cpp
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Records spans of time spent in each part of the search and writes
+ *          them in the Chrome trace event format.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include "scrabble_trace.h"
+
+bool global_tracing = false;
+mutex global_trace_mutex;
+vector <TraceBuffer*> global_trace_buffers;
+
+/**
+ * Starts a span if tracing is enabled. The span ends when it is destroyed.
+ *
+ * @param   name        the name of the span (ex. "anchor")
+ * @param   category    the category of the span (ex. "search")
+ * @param   row         the row of the span or -1 if there is none
+ * @param   col         the column of the span or -1 if there is none
+ */
+TraceSpan::TraceSpan (const char* name, const char* category, int row, int col)
+{
+    this->name = name;
+    this->category = category;
+    this->row = row;
+    this->col = col;
+    this->start_nanos = global_tracing ? get_trace_nanos() : -1;
+}
+
+/**
+ * Records the span in the ring buffer of the calling thread.
+ */
+TraceSpan::~TraceSpan ()
+{
+    if (start_nanos == -1)
+    {
+        return;
+    }
+
+    TraceEvent event;
+    event.name = name;
+    event.category = category;
+    event.start_nanos = start_nanos;
+    event.duration_nanos = get_trace_nanos() - start_nanos;
+    event.row = row;
+    event.col = col;
+
+    TraceBuffer* buffer = get_trace_buffer();
+    buffer->events[buffer->num_events % TRACE_BUFFER_SIZE] = event;
+    buffer->num_events++;
+}
+
+/**
+ * @return  the number of nanoseconds since the program started
+ */
+long long get_trace_nanos ()
+{
+    static auto program_start = chrono::steady_clock::now();
+    auto now = chrono::steady_clock::now();
+    return chrono::duration_cast <chrono::nanoseconds>
+                                 (now - program_start).count();
+}
+
+/**
+ * Returns the ring buffer of the calling thread. The buffer is created the
+ * first time a thread records a span so that threads never share a buffer.
+ *
+ * @return  a pointer to the TraceBuffer of the calling thread
+ */
+TraceBuffer* get_trace_buffer ()
+{
+    thread_local TraceBuffer* buffer = NULL;
+
+    if (buffer == NULL)
+    {
+        buffer = new TraceBuffer;
+        buffer->events.resize(TRACE_BUFFER_SIZE);
+        buffer->num_events = 0;
+
+        lock_guard <mutex> lock (global_trace_mutex);
+        buffer->thread_id = global_trace_buffers.size() + 1;
+        global_trace_buffers.push_back(buffer);
+    }
+
+    return buffer;
+}
+
+/**
+ * Writes the spans of every thread to a file in the Chrome trace event format,
+ * which can be opened in chrome://tracing or Perfetto. Only the most recent
+ * TRACE_BUFFER_SIZE spans of each thread are kept. Must be called after the
+ * traced threads have finished.
+ *
+ * @param   file_name   the name of the JSON file to create
+ * @return              false if the file could not be created
+ */
+bool write_trace (string file_name)
+{
+    ofstream out_file;
+    out_file.open(file_name.c_str(), ofstream::out);
+
+    // Ensure file is open
+    if (!out_file.is_open())
+    {
+        return false;
+    }
+
+    lock_guard <mutex> lock (global_trace_mutex);
+    string separator = "\n";
+    out_file << fixed << setprecision(3);
+    out_file << "{\"traceEvents\": [";
+
+    for (unsigned int i = 0; i < global_trace_buffers.size(); i++)
+    {
+        TraceBuffer* buffer = global_trace_buffers[i];
+
+        // Name the thread
+        out_file << separator << "{\"name\": \"thread_name\", \"ph\": \"M\", "
+                 << "\"pid\": 1, \"tid\": " << buffer->thread_id << ", "
+                 << "\"args\": {\"name\": \"thread " << buffer->thread_id
+                 << "\"}}";
+        separator = ",\n";
+
+        // Go through the spans from oldest to newest
+        unsigned long long first = 0;
+
+        if (buffer->num_events > TRACE_BUFFER_SIZE)
+        {
+            first = buffer->num_events - TRACE_BUFFER_SIZE;
+        }
+
+        for (unsigned long long j = first; j < buffer->num_events; j++)
+        {
+            TraceEvent &event = buffer->events[j % TRACE_BUFFER_SIZE];
+
+            // Chrome expects the times in microseconds
+            out_file << separator << "{\"name\": \"" << event.name << "\", "
+                     << "\"cat\": \"" << event.category << "\", "
+                     << "\"ph\": \"X\", \"pid\": 1, "
+                     << "\"tid\": " << buffer->thread_id << ", "
+                     << "\"ts\": " << event.start_nanos / 1000.0 << ", "
+                     << "\"dur\": " << event.duration_nanos / 1000.0;
+
+            if (event.row != -1 || event.col != -1)
+            {
+                out_file << ", \"args\": {\"row\": " << event.row
+                         << ", \"col\": " << event.col << "}";
+            }
+
+            out_file << "}";
+        }
+    }
+
+    out_file << "\n]}" << endl;
+    return out_file.good();
+}
@@ -0,0 +1,69 @@
+/**
+ * scrabble_trace.h
+ *
+ * This code is the property of its creator W. Lei.
+ *
+ * Purpose: Records spans of time spent in each part of the search, such as
+ *          rows and anchors, in a ring buffer for each thread. The spans can
+ *          be written as a Chrome trace to find where the time goes.
+ *
+ * Contact Email: leiw9425@gmail.com
+ */
+
+#ifndef SCRABBLE_TRACE_H
+#define SCRABBLE_TRACE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#define TRACE_BUFFER_SIZE 65536
+
+using namespace std;
+
+// A span of time spent by one thread in one part of the search
+struct TraceEvent
+{
+    const char* name;
+    const char* category;
+    long long start_nanos;
+    long long duration_nanos;
+    int row;    // -1 if the span is not for a row
+    int col;    // -1 if the span is not for a square
+};
+
+// The ring buffer of spans recorded by one thread
+struct TraceBuffer
+{
+    vector <TraceEvent> events;
+    unsigned long long num_events;  // All spans ever recorded by the thread
+    int thread_id;
+};
+
+// Records a span from its construction to its destruction while tracing
+class TraceSpan
+{
+public:
+    TraceSpan (const char* name, const char* category,
+               int row = -1, int col = -1);
+    ~TraceSpan ();
+
+private:
+    const char* name;
+    const char* category;
+    int row;
+    int col;
+    long long start_nanos;  // -1 if tracing was disabled at the start
+};
+
+// The spans are only recorded when tracing is enabled with --trace
+extern bool global_tracing;
+extern mutex global_trace_mutex;
+extern vector <TraceBuffer*> global_trace_buffers;
+
+// Declare functions
+long long get_trace_nanos ();
+TraceBuffer* get_trace_buffer ();
+bool write_trace (string file_name);
+
+#endif